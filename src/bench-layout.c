@@ -0,0 +1,662 @@
+/* bench-layout.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless layout benchmarks for the dock containers.
+ *
+ * Each layout is placed in a GtkOffscreenWindow so that no compositor or
+ * GPU is required. This runs fine under Xvfb or GDK_BACKEND=broadway.
+ * Results are written to stdout, one JSON object per line, so that they
+ * can be collected and compared in CI.
+ */
+
+#include "pnl.h"
+
+#define WINDOW_WIDTH  1280
+#define WINDOW_HEIGHT 800
+
+#define N_TWEENS            64
+#define TWEEN_DURATION_MSEC 500
+
+typedef void (*BenchDragFunc)    (GtkWidget *root,
+                                  gint       position);
+typedef PnlAnimation *(*BenchAnimateFunc) (gpointer   target,
+                                            gpointer   user_data);
+
+typedef struct
+{
+  guint  n_running;
+  guint  n_ticks;
+  gint64 total_usec;
+} TickStats;
+
+static gint iterations = 200;
+static gchar *only;
+
+static GOptionEntry entries[] = {
+  { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+    "Number of iterations per measurement", "N" },
+  { "only", 'o', 0, G_OPTION_ARG_STRING, &only,
+    "Only run layouts whose name starts with PREFIX", "PREFIX" },
+  { NULL }
+};
+
+static void
+flush_events (void)
+{
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+static void
+report (const gchar *layout,
+        guint        n_children,
+        const gchar *operation,
+        gint64       elapsed_usec)
+{
+  g_print ("{\"layout\": \"%s\", \"children\": %u, \"operation\": \"%s\", "
+           "\"iterations\": %d, \"total_usec\": %"G_GINT64_FORMAT", "
+           "\"usec_per_iteration\": %.3f}\n",
+           layout,
+           n_children,
+           operation,
+           iterations,
+           elapsed_usec,
+           (gdouble)elapsed_usec / (gdouble)MAX (iterations, 1));
+}
+
+static void
+layout_cycle (GtkWidget *root,
+              gint       width,
+              gint       height)
+{
+  GtkAllocation alloc = { 0, 0, width, height };
+  GtkRequisition min_req;
+
+  gtk_widget_get_preferred_size (root, &min_req, NULL);
+  gtk_widget_size_allocate (root, &alloc);
+}
+
+static void
+collect_leaves (GtkWidget *widget,
+                gpointer   user_data)
+{
+  GPtrArray *leaves = user_data;
+  guint len = leaves->len;
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), collect_leaves, leaves);
+
+  /* Containers without children are leaves as well. */
+  if (leaves->len == len)
+    g_ptr_array_add (leaves, widget);
+}
+
+static void
+run_layout (const gchar   *name,
+            guint          n_children,
+            GtkWidget     *root,
+            BenchDragFunc  drag_func)
+{
+  cairo_surface_t *surface;
+  GtkWidget *window;
+  GPtrArray *leaves;
+  gint64 begin;
+  gint i;
+
+  g_assert (GTK_IS_WIDGET (root));
+
+  if (only != NULL && !g_str_has_prefix (name, only))
+    {
+      gtk_widget_destroy (root);
+      return;
+    }
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), WINDOW_WIDTH, WINDOW_HEIGHT);
+  gtk_container_add (GTK_CONTAINER (window), root);
+  gtk_widget_show_all (window);
+  flush_events ();
+
+  /*
+   * Measure: invalidate every leaf widget, so that the request of every
+   * container between the leaves and the root has to be recomputed, and
+   * ask for the root request again.
+   */
+  leaves = g_ptr_array_new ();
+  collect_leaves (root, leaves);
+  begin = g_get_monotonic_time ();
+  for (i = 0; i < iterations; i++)
+    {
+      gint min_size;
+      gint nat_size;
+      guint j;
+
+      for (j = 0; j < leaves->len; j++)
+        gtk_widget_queue_resize (g_ptr_array_index (leaves, j));
+      gtk_widget_get_preferred_width (root, &min_size, &nat_size);
+      gtk_widget_get_preferred_height (root, &min_size, &nat_size);
+    }
+  report (name, n_children, "measure", g_get_monotonic_time () - begin);
+  g_ptr_array_unref (leaves);
+
+  /*
+   * Allocate: alternate between two sizes so that every iteration
+   * really reallocates the children.
+   */
+  begin = g_get_monotonic_time ();
+  for (i = 0; i < iterations; i++)
+    layout_cycle (root, WINDOW_WIDTH - (i & 1), WINDOW_HEIGHT - (i & 1));
+  report (name, n_children, "allocate", g_get_monotonic_time () - begin);
+
+  /*
+   * Draw: render the whole layout to an image surface.
+   */
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, WINDOW_WIDTH, WINDOW_HEIGHT);
+  begin = g_get_monotonic_time ();
+  for (i = 0; i < iterations; i++)
+    {
+      cairo_t *cr = cairo_create (surface);
+
+      gtk_widget_draw (root, cr);
+      cairo_destroy (cr);
+    }
+  report (name, n_children, "draw", g_get_monotonic_time () - begin);
+  cairo_surface_destroy (surface);
+
+  /*
+   * Drag: move a handle back and forth like a pointer would, running a
+   * layout cycle for every step.
+   */
+  if (drag_func != NULL)
+    {
+      begin = g_get_monotonic_time ();
+      for (i = 0; i < iterations; i++)
+        {
+          drag_func (root, 200 + (i % 100));
+          layout_cycle (root, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+      report (name, n_children, "drag", g_get_monotonic_time () - begin);
+    }
+
+  gtk_widget_destroy (window);
+  flush_events ();
+}
+
+static GtkWidget *
+create_dock_stack (const gchar *prefix)
+{
+  GtkWidget *stack;
+  guint i;
+
+  stack = pnl_dock_stack_new ();
+
+  for (i = 0; i < 2; i++)
+    {
+      g_autofree gchar *title = g_strdup_printf ("%s %u", prefix, i);
+      GtkWidget *widget;
+
+      widget = g_object_new (PNL_TYPE_DOCK_WIDGET,
+                             "title", title,
+                             "visible", TRUE,
+                             NULL);
+      gtk_container_add (GTK_CONTAINER (widget),
+                         g_object_new (GTK_TYPE_LABEL,
+                                       "label", title,
+                                       "visible", TRUE,
+                                       NULL));
+      gtk_container_add (GTK_CONTAINER (stack), widget);
+    }
+
+  return stack;
+}
+
+static void
+dock_bin_drag (GtkWidget *root,
+               gint       position)
+{
+  GtkWidget *edge = pnl_dock_bin_get_left_edge (PNL_DOCK_BIN (root));
+
+  g_object_set (edge, "position", position, NULL);
+}
+
+static GtkWidget *
+create_dock_bin (void)
+{
+  GtkWidget *dock;
+  GtkWidget *scroller;
+  GtkWidget *edges[4];
+  guint i;
+
+  dock = pnl_dock_bin_new ();
+
+  scroller = g_object_new (GTK_TYPE_SCROLLED_WINDOW,
+                           "expand", TRUE,
+                           NULL);
+  gtk_container_add (GTK_CONTAINER (scroller), gtk_text_view_new ());
+  gtk_container_add (GTK_CONTAINER (dock), scroller);
+
+  edges[0] = pnl_dock_bin_get_left_edge (PNL_DOCK_BIN (dock));
+  edges[1] = pnl_dock_bin_get_right_edge (PNL_DOCK_BIN (dock));
+  edges[2] = pnl_dock_bin_get_top_edge (PNL_DOCK_BIN (dock));
+  edges[3] = pnl_dock_bin_get_bottom_edge (PNL_DOCK_BIN (dock));
+
+  for (i = 0; i < G_N_ELEMENTS (edges); i++)
+    {
+      gtk_container_add (GTK_CONTAINER (edges[i]), create_dock_stack ("Panel"));
+      gtk_revealer_set_reveal_child (GTK_REVEALER (edges[i]), TRUE);
+    }
+
+  return dock;
+}
+
+static void
+multi_paned_drag (GtkWidget *root,
+                  gint       position)
+{
+  GList *children = gtk_container_get_children (GTK_CONTAINER (root));
+
+  if (children != NULL)
+    gtk_container_child_set (GTK_CONTAINER (root), children->data,
+                             "position", position,
+                             NULL);
+
+  g_list_free (children);
+}
+
+static GtkWidget *
+create_multi_paned (guint n_children)
+{
+  GtkWidget *paned;
+  guint i;
+
+  paned = pnl_multi_paned_new ();
+
+  for (i = 0; i < n_children; i++)
+    {
+      g_autofree gchar *label = g_strdup_printf ("%u", i);
+
+      gtk_container_add (GTK_CONTAINER (paned), gtk_label_new (label));
+    }
+
+  return paned;
+}
+
+static GtkWidget *
+create_nested_paned (guint  depth,
+                     guint  fan_out,
+                     guint *n_children)
+{
+  GtkWidget *paned;
+  guint i;
+
+  paned = g_object_new (PNL_TYPE_DOCK_PANED,
+                        "orientation", (depth & 1) ? GTK_ORIENTATION_VERTICAL
+                                                   : GTK_ORIENTATION_HORIZONTAL,
+                        NULL);
+
+  for (i = 0; i < fan_out; i++)
+    {
+      GtkWidget *child;
+
+      if (depth > 1)
+        child = create_nested_paned (depth - 1, fan_out, n_children);
+      else
+        child = create_dock_stack ("Page");
+
+      gtk_container_add (GTK_CONTAINER (paned), child);
+      (*n_children)++;
+    }
+
+  return paned;
+}
+
+static GtkWidget *
+create_tab_strip (guint n_pages,
+                  guint max_tabs)
+{
+  GtkWidget *box;
+  GtkWidget *stack;
+  GtkWidget *tab_strip;
+  guint i;
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  stack = gtk_stack_new ();
+  tab_strip = g_object_new (PNL_TYPE_TAB_STRIP,
+                            "edge", GTK_POS_TOP,
+                            "max-tabs", max_tabs,
+                            "stack", stack,
+                            NULL);
+
+  gtk_container_add (GTK_CONTAINER (box), tab_strip);
+  gtk_container_add (GTK_CONTAINER (box), stack);
+
+  for (i = 0; i < n_pages; i++)
+    {
+      g_autofree gchar *title = g_strdup_printf ("Document %u", i);
+
+      gtk_stack_add_titled (GTK_STACK (stack), gtk_label_new (title), title, title);
+    }
+
+  return box;
+}
+
+/*
+ * Perspective switch: move every panel from the left edge of a dock to
+ * the right edge (and back on the next iteration), then run one layout
+ * cycle, as applying a saved perspective would. A switch should fit in
+ * a frame, so usec_per_iteration is best compared against 16667.
+ */
+static void
+run_perspective (guint    n_panels,
+                 gboolean use_transaction)
+{
+  const gchar *name = use_transaction ? "perspective-transaction" : "perspective";
+  PnlDockManager *manager;
+  GtkWidget *window;
+  GtkWidget *dock;
+  GtkWidget *stacks[2];
+  GPtrArray *panels;
+  gint64 begin;
+  guint i;
+  gint j;
+
+  if (only != NULL && !g_str_has_prefix (name, only))
+    return;
+
+  manager = pnl_dock_manager_new ();
+  dock = g_object_new (PNL_TYPE_DOCK_BIN,
+                       "manager", manager,
+                       NULL);
+  gtk_container_add (GTK_CONTAINER (dock), gtk_text_view_new ());
+
+  stacks[0] = pnl_dock_stack_new ();
+  stacks[1] = pnl_dock_stack_new ();
+  gtk_container_add (GTK_CONTAINER (pnl_dock_bin_get_left_edge (PNL_DOCK_BIN (dock))), stacks[0]);
+  gtk_container_add (GTK_CONTAINER (pnl_dock_bin_get_right_edge (PNL_DOCK_BIN (dock))), stacks[1]);
+  gtk_revealer_set_reveal_child (GTK_REVEALER (pnl_dock_bin_get_left_edge (PNL_DOCK_BIN (dock))), TRUE);
+  gtk_revealer_set_reveal_child (GTK_REVEALER (pnl_dock_bin_get_right_edge (PNL_DOCK_BIN (dock))), TRUE);
+
+  panels = g_ptr_array_new ();
+
+  for (i = 0; i < n_panels; i++)
+    {
+      g_autofree gchar *title = g_strdup_printf ("Panel %u", i);
+      GtkWidget *widget;
+
+      widget = g_object_new (PNL_TYPE_DOCK_WIDGET,
+                             "title", title,
+                             NULL);
+      gtk_container_add (GTK_CONTAINER (widget), gtk_label_new (title));
+      gtk_container_add (GTK_CONTAINER (stacks[0]), widget);
+      g_ptr_array_add (panels, widget);
+    }
+
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), WINDOW_WIDTH, WINDOW_HEIGHT);
+  gtk_container_add (GTK_CONTAINER (window), dock);
+  gtk_widget_show_all (window);
+  flush_events ();
+
+  begin = g_get_monotonic_time ();
+  for (j = 0; j < iterations; j++)
+    {
+      GtkWidget *target = stacks[(j + 1) & 1];
+
+      if (use_transaction)
+        pnl_dock_manager_begin_transaction (manager);
+
+      for (i = 0; i < panels->len; i++)
+        {
+          GtkWidget *widget = g_ptr_array_index (panels, i);
+
+          g_object_ref (widget);
+          gtk_container_remove (GTK_CONTAINER (gtk_widget_get_parent (widget)), widget);
+          gtk_container_add (GTK_CONTAINER (target), widget);
+          g_object_unref (widget);
+        }
+
+      if (use_transaction)
+        pnl_dock_manager_commit_transaction (manager);
+
+      layout_cycle (dock, WINDOW_WIDTH, WINDOW_HEIGHT);
+    }
+  report (name, n_panels, "switch", g_get_monotonic_time () - begin);
+
+  g_ptr_array_unref (panels);
+  gtk_widget_destroy (window);
+  flush_events ();
+  g_object_unref (manager);
+}
+
+static void
+tick_animation_tick (PnlAnimation *animation,
+                     gpointer      user_data)
+{
+  TickStats *stats = user_data;
+
+  stats->n_ticks++;
+}
+
+static void
+tick_animation_done (gpointer user_data)
+{
+  TickStats *stats = user_data;
+
+  stats->n_running--;
+}
+
+static PnlAnimation *
+animate_adjustment_value (gpointer target,
+                          gpointer user_data)
+{
+  return pnl_object_animate_full (target,
+                                  PNL_ANIMATION_LINEAR,
+                                  TWEEN_DURATION_MSEC,
+                                  NULL,
+                                  tick_animation_done,
+                                  user_data,
+                                  "value", 90.0,
+                                  NULL);
+}
+
+static PnlAnimation *
+animate_paned_position (gpointer target,
+                        gpointer user_data)
+{
+  return pnl_object_animate_full (target,
+                                  PNL_ANIMATION_LINEAR,
+                                  TWEEN_DURATION_MSEC,
+                                  NULL,
+                                  tick_animation_done,
+                                  user_data,
+                                  "position", 200,
+                                  NULL);
+}
+
+/* "step-increment" has no direct setter, so this takes the GValue path. */
+static PnlAnimation *
+animate_adjustment_generic (gpointer target,
+                            gpointer user_data)
+{
+  return pnl_object_animate_full (target,
+                                  PNL_ANIMATION_LINEAR,
+                                  TWEEN_DURATION_MSEC,
+                                  NULL,
+                                  tick_animation_done,
+                                  user_data,
+                                  "step-increment", 10.0,
+                                  NULL);
+}
+
+/*
+ * Animation ticks: run one tween on each of @targets until all of them
+ * complete, and report the average cost of a PnlAnimation tick. Only the
+ * main loop iterations that dispatched something are timed, so the time
+ * spent waiting for the next frame is not counted.
+ */
+static void
+run_ticks (const gchar      *name,
+           GPtrArray        *targets,
+           BenchAnimateFunc  animate_func)
+{
+  TickStats stats = { 0 };
+  gint64 begin;
+  gboolean dispatched;
+  guint i;
+
+  g_assert (targets != NULL);
+  g_assert (animate_func != NULL);
+
+  if (only != NULL && !g_str_has_prefix (name, only))
+    return;
+
+  /* Frame clock driven tweens complete immediately otherwise. */
+  g_object_set (gtk_settings_get_default (),
+                "gtk-enable-animations", TRUE,
+                NULL);
+
+  for (i = 0; i < targets->len; i++)
+    {
+      PnlAnimation *animation;
+
+      stats.n_running++;
+      animation = animate_func (g_ptr_array_index (targets, i), &stats);
+      g_signal_connect (animation,
+                        "tick",
+                        G_CALLBACK (tick_animation_tick),
+                        &stats);
+    }
+
+  while (stats.n_running > 0)
+    {
+      begin = g_get_monotonic_time ();
+      dispatched = g_main_context_iteration (NULL, FALSE);
+
+      if (dispatched)
+        stats.total_usec += g_get_monotonic_time () - begin;
+      else
+        g_usleep (G_USEC_PER_SEC / 1000);
+    }
+
+  g_object_set (gtk_settings_get_default (),
+                "gtk-enable-animations", FALSE,
+                NULL);
+
+  g_print ("{\"layout\": \"%s\", \"children\": %u, \"operation\": \"tick\", "
+           "\"iterations\": %u, \"total_usec\": %"G_GINT64_FORMAT", "
+           "\"usec_per_iteration\": %.3f}\n",
+           name,
+           targets->len,
+           stats.n_ticks,
+           stats.total_usec,
+           (gdouble)stats.total_usec / (gdouble)MAX (stats.n_ticks, 1));
+}
+
+static void
+collect_child (GtkWidget *widget,
+               gpointer   user_data)
+{
+  g_ptr_array_add (user_data, widget);
+}
+
+static void
+run_animations (void)
+{
+  GtkWidget *window;
+  GtkWidget *paned;
+  GPtrArray *targets;
+  guint i;
+
+  targets = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < N_TWEENS; i++)
+    g_ptr_array_add (targets, g_object_ref_sink (gtk_adjustment_new (0.0, 0.0, 100.0, 1.0, 10.0, 0.0)));
+  run_ticks ("animation-adjustment", targets, animate_adjustment_value);
+  run_ticks ("animation-generic", targets, animate_adjustment_generic);
+  g_ptr_array_unref (targets);
+
+  paned = create_multi_paned (N_TWEENS);
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), WINDOW_WIDTH * 8, WINDOW_HEIGHT);
+  gtk_container_add (GTK_CONTAINER (window), paned);
+  gtk_widget_show_all (window);
+  flush_events ();
+
+  targets = g_ptr_array_new ();
+  gtk_container_foreach (GTK_CONTAINER (paned), collect_child, targets);
+  run_ticks ("animation-paned-position", targets, animate_paned_position);
+  g_ptr_array_unref (targets);
+
+  gtk_widget_destroy (window);
+  flush_events ();
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  GOptionContext *context;
+  GtkWidget *nested;
+  GError *error = NULL;
+  guint n_children = 0;
+  guint i;
+
+  context = g_option_context_new ("- benchmark dock layouts");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+      return EXIT_FAILURE;
+    }
+
+  g_option_context_free (context);
+
+  /* Keep revealers and stacks from animating during the runs. */
+  g_object_set (gtk_settings_get_default (),
+                "gtk-enable-animations", FALSE,
+                NULL);
+
+  run_layout ("dock-bin", 5, create_dock_bin (), dock_bin_drag);
+
+  for (i = 2; i <= 64; i *= 2)
+    run_layout ("multi-paned", i, create_multi_paned (i), multi_paned_drag);
+
+  nested = create_nested_paned (3, 3, &n_children);
+  run_layout ("nested-dock-paned", n_children, nested, multi_paned_drag);
+
+  for (i = 10; i <= 1000; i *= 10)
+    {
+      run_layout ("tab-strip", i, create_tab_strip (i, 0), NULL);
+      run_layout ("tab-strip-virtual", i, create_tab_strip (i, 8), NULL);
+    }
+
+  for (i = 10; i <= 100; i *= 10)
+    {
+      run_perspective (i, FALSE);
+      run_perspective (i, TRUE);
+    }
+
+  run_animations ();
+
+  g_free (only);
+
+  return EXIT_SUCCESS;
+}
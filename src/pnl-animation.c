@@ -25,6 +25,8 @@
 
 #include "pnl-animation.h"
 #include "pnl-frame-source.h"
+#include "pnl-multi-paned-private.h"
+#include "pnl-trace-private.h"
 
 #define FALLBACK_FRAME_RATE 60
 
@@ -34,30 +36,59 @@ typedef void    (*TweenFunc) (const GValue *begin,
                               GValue       *value,
                               gdouble       offset);
 
+typedef struct _Tween Tween;
+
+typedef void    (*TweenSetter) (gpointer      target,
+                                const Tween  *tween,
+                                gdouble       offset);
+
+struct _Tween
+{
+  gboolean     is_child;  /* Does GParamSpec belong to parent widget */
+  GParamSpec  *pspec;     /* GParamSpec of target property */
+  GValue       begin;     /* Begin value in animation */
+  GValue       end;       /* End value in animation */
+  GValue       value;     /* Scratch value used when there is no setter */
+  TweenSetter  setter;    /* Direct setter resolved at add time, or NULL */
+  gboolean     released;  /* Taken over by another animation during a tick */
+};
+
+
+/*
+ * All animations synchronized to the same GdkFrameClock are driven by a
+ * single timeline attached to that frame clock. This keeps us at one pair
+ * of signal handlers and one gdk_frame_clock_begin_updating() request per
+ * frame clock, regardless of how many animations are running.
+ */
 typedef struct
 {
-  gboolean    is_child;  /* Does GParamSpec belong to parent widget */
-  GParamSpec *pspec;     /* GParamSpec of target property */
-  GValue      begin;     /* Begin value in animation */
-  GValue      end;       /* End value in animation */
-} Tween;
+  GdkFrameClock *frame_clock;         /* Owning frame clock (unowned) */
+  GPtrArray     *animations;          /* Running animations (unowned) */
+  gulong         update_handler;      /* "update" signal handler */
+  gulong         after_paint_handler; /* "after-paint" signal handler */
+  guint          dispatch_depth;      /* Non-zero while ticking animations */
+  guint          needs_compact : 1;   /* Stopped during dispatch */
+} PnlAnimationTimeline;
 
 
 struct _PnlAnimation
 {
-  GInitiallyUnowned  parent_instance;
-
-  gpointer           target;              /* Target object to animate */
-  guint64            begin_msec;          /* Time in which animation started */
-  guint              duration_msec;       /* Duration of animation */
-  guint              mode;                /* Tween mode */
-  gulong             tween_handler;       /* GSource or signal handler */
-  gulong             after_paint_handler; /* signal handler */
-  gdouble            last_offset;         /* Track our last offset */
-  GArray            *tweens;              /* Array of tweens to perform */
-  GdkFrameClock     *frame_clock;         /* An optional frame-clock for sync. */
-  GDestroyNotify     notify;              /* Notify callback */
-  gpointer           notify_data;         /* Data for notify */
+  GInitiallyUnowned     parent_instance;
+
+  gpointer              target;              /* Target object to animate */
+  guint64               begin_msec;          /* Time in which animation started */
+  guint                 duration_msec;       /* Duration of animation */
+  guint                 mode;                /* Tween mode */
+  gulong                tween_handler;       /* GSource when not frame synced */
+  PnlAnimationTimeline *timeline;            /* Frame clock timeline while running */
+  gdouble               last_offset;         /* Track our last offset */
+  guint                 in_tick : 1;         /* Inside pnl_animation_tick() */
+  guint                 superseded : 1;      /* All tweens taken by others */
+  guint                 n_released;          /* Released tweens awaiting removal */
+  GArray               *tweens;              /* Array of tweens to perform */
+  GdkFrameClock        *frame_clock;         /* An optional frame-clock for sync. */
+  GDestroyNotify        notify;              /* Notify callback */
+  gpointer              notify_data;         /* Data for notify */
 };
 
 G_DEFINE_TYPE (PnlAnimation, pnl_animation, G_TYPE_INITIALLY_UNOWNED)
@@ -104,6 +135,8 @@ static GParamSpec *properties[LAST_PROP];
 static guint       signals[LAST_SIGNAL];
 static TweenFunc   tween_funcs[LAST_FUNDAMENTAL];
 static guint       slow_down_factor = 1;
+static GQuark      timeline_quark;
+static GQuark      registry_quark;
 
 
 /*
@@ -117,6 +150,40 @@ TWEEN (float);
 TWEEN (double);
 
 
+/*
+ * Direct setters for the most common animation targets. These avoid
+ * boxing the new value in a GValue and looking up the property by name
+ * on every frame.
+ */
+static void
+tween_set_adjustment_value (gpointer     target,
+                            const Tween *tween,
+                            gdouble      offset)
+{
+  gdouble x = g_value_get_double (&tween->begin);
+  gdouble y = g_value_get_double (&tween->end);
+
+  gtk_adjustment_set_value (target, x + ((y - x) * offset));
+}
+
+static void
+tween_set_multi_paned_position (gpointer     target,
+                                const Tween *tween,
+                                gdouble      offset)
+{
+  GtkWidget *parent;
+  gint x = g_value_get_int (&tween->begin);
+  gint y = g_value_get_int (&tween->end);
+
+  parent = gtk_widget_get_parent (target);
+
+  if (PNL_IS_MULTI_PANED (parent))
+    pnl_multi_paned_set_child_position (PNL_MULTI_PANED (parent),
+                                        target,
+                                        x + ((y - x) * offset));
+}
+
+
 /**
  * pnl_animation_alpha_ease_in_cubic:
  * @offset: (in): The position within the animation; 0.0 to 1.0.
@@ -226,6 +293,13 @@ pnl_animation_alpha_ease_in_out_quad (gdouble offset)
 }
 
 
+static inline gboolean
+pnl_animation_is_running (PnlAnimation *animation)
+{
+  return (animation->tween_handler != 0) || (animation->timeline != NULL);
+}
+
+
 /**
  * pnl_animation_load_begin_values:
  * @animation: (in): A #PnlAnimation.
@@ -452,6 +526,94 @@ pnl_animation_set_target (PnlAnimation *animation,
 }
 
 
+/**
+ * pnl_animation_find_setter:
+ * @animation: (in): A #PnlAnimation.
+ * @tween: (in): A #Tween.
+ *
+ * Locates a direct setter for @tween so that pnl_animation_tick() can
+ * avoid the generic GValue based property path.
+ *
+ * Returns: A #TweenSetter or %NULL.
+ */
+static TweenSetter
+pnl_animation_find_setter (PnlAnimation *animation,
+                           const Tween  *tween)
+{
+  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (tween != NULL);
+
+  if (!tween->is_child)
+    {
+      if (GTK_IS_ADJUSTMENT (animation->target) &&
+          tween->pspec->owner_type == GTK_TYPE_ADJUSTMENT &&
+          tween->pspec->value_type == G_TYPE_DOUBLE &&
+          g_str_equal (tween->pspec->name, "value"))
+        return tween_set_adjustment_value;
+    }
+  else
+    {
+      GtkWidget *parent = gtk_widget_get_parent (animation->target);
+
+      if (PNL_IS_MULTI_PANED (parent) &&
+          tween->pspec->owner_type == PNL_TYPE_MULTI_PANED &&
+          tween->pspec->value_type == G_TYPE_INT &&
+          g_str_equal (tween->pspec->name, "position"))
+        return tween_set_multi_paned_position;
+    }
+
+  return NULL;
+}
+
+
+/**
+ * pnl_animation_clear_tween:
+ * @tween: (in): A #Tween.
+ *
+ * Releases the values and the #GParamSpec held by @tween.
+ */
+static void
+pnl_animation_clear_tween (Tween *tween)
+{
+  g_value_unset (&tween->begin);
+  g_value_unset (&tween->end);
+  g_value_unset (&tween->value);
+  g_param_spec_unref (tween->pspec);
+}
+
+
+/**
+ * pnl_animation_compact_tweens:
+ * @animation: (in): A #PnlAnimation.
+ *
+ * Removes the tweens that were released while @animation was ticking.
+ */
+static void
+pnl_animation_compact_tweens (PnlAnimation *animation)
+{
+  guint i;
+
+  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (!animation->in_tick);
+
+  if (animation->n_released == 0)
+    return;
+
+  for (i = animation->tweens->len; i > 0; i--)
+    {
+      Tween *tween = &g_array_index (animation->tweens, Tween, i - 1);
+
+      if (tween->released)
+        {
+          pnl_animation_clear_tween (tween);
+          g_array_remove_index (animation->tweens, i - 1);
+        }
+    }
+
+  animation->n_released = 0;
+}
+
+
 /**
  * pnl_animation_tick:
  * @animation: (in): A #PnlAnimation.
@@ -466,14 +628,25 @@ pnl_animation_tick (PnlAnimation *animation,
                     gdouble       offset)
 {
   gdouble alpha;
-  GValue value = { 0 };
   Tween *tween;
   guint i;
+  PNL_TRACE_BEGIN;
 
   g_return_val_if_fail (PNL_IS_ANIMATION (animation), FALSE);
 
+  if (animation->superseded)
+    {
+      PNL_TRACE_END ("PnlAnimation.tick");
+      return FALSE;
+    }
+
   if (offset == animation->last_offset)
-    return offset < 1.0;
+    {
+      PNL_TRACE_END ("PnlAnimation.tick");
+      return offset < 1.0;
+    }
+
+  animation->in_tick = TRUE;
 
   alpha = alpha_funcs[animation->mode](offset);
 
@@ -483,23 +656,34 @@ pnl_animation_tick (PnlAnimation *animation,
   for (i = 0; i < animation->tweens->len; i++)
     {
       tween = &g_array_index (animation->tweens, Tween, i);
-      g_value_init (&value, tween->pspec->value_type);
-      pnl_animation_get_value_at_offset (animation, alpha, tween, &value);
+
+      if (tween->released)
+        continue;
+
+      if (tween->setter != NULL)
+        {
+          tween->setter (animation->target, tween, alpha);
+          continue;
+        }
+
+      if (tween->value.g_type >= LAST_FUNDAMENTAL)
+        g_value_reset (&tween->value);
+
+      pnl_animation_get_value_at_offset (animation, alpha, tween, &tween->value);
       if (!tween->is_child)
         {
           pnl_animation_update_property (animation,
                                         animation->target,
                                         tween,
-                                        &value);
+                                        &tween->value);
         }
       else
         {
           pnl_animation_update_child_property (animation,
                                               animation->target,
                                               tween,
-                                              &value);
+                                              &tween->value);
         }
-      g_value_unset (&value);
     }
 
   /*
@@ -521,6 +705,18 @@ pnl_animation_tick (PnlAnimation *animation,
 #endif
 
   animation->last_offset = offset;
+  animation->in_tick = FALSE;
+
+  pnl_animation_compact_tweens (animation);
+
+  PNL_TRACE_END ("PnlAnimation.tick");
+
+  /*
+   * If another animation took over every property while we were updating,
+   * let the caller stop us now rather than after another frame.
+   */
+  if (animation->superseded)
+    return FALSE;
 
   return offset < 1.0;
 }
@@ -551,47 +747,342 @@ pnl_animation_timeout_cb (gpointer user_data)
 }
 
 
-static gboolean
-pnl_animation_widget_tick_cb (GdkFrameClock *frame_clock,
-                              PnlAnimation  *animation)
+static void
+pnl_animation_timeline_free (gpointer data)
+{
+  PnlAnimationTimeline *timeline = data;
+
+  g_assert (timeline != NULL);
+  g_assert (timeline->animations->len == 0);
+
+  g_ptr_array_unref (timeline->animations);
+  g_slice_free (PnlAnimationTimeline, timeline);
+}
+
+
+/**
+ * pnl_animation_timeline_compact:
+ * @timeline: A #PnlAnimationTimeline.
+ *
+ * Removes animations that were stopped while the timeline was dispatching
+ * and releases the frame clock once no animations remain.
+ */
+static void
+pnl_animation_timeline_compact (PnlAnimationTimeline *timeline)
+{
+  g_assert (timeline != NULL);
+
+  if (timeline->dispatch_depth > 0)
+    return;
+
+  if (timeline->needs_compact)
+    {
+      guint i;
+
+      for (i = timeline->animations->len; i > 0; i--)
+        {
+          if (g_ptr_array_index (timeline->animations, i - 1) == NULL)
+            g_ptr_array_remove_index_fast (timeline->animations, i - 1);
+        }
+
+      timeline->needs_compact = FALSE;
+    }
+
+  if (timeline->animations->len == 0 && timeline->update_handler != 0)
+    {
+      g_signal_handler_disconnect (timeline->frame_clock, timeline->update_handler);
+      g_signal_handler_disconnect (timeline->frame_clock, timeline->after_paint_handler);
+      timeline->update_handler = 0;
+      timeline->after_paint_handler = 0;
+      gdk_frame_clock_end_updating (timeline->frame_clock);
+    }
+}
+
+
+static void
+pnl_animation_timeline_update_cb (GdkFrameClock        *frame_clock,
+                                  PnlAnimationTimeline *timeline)
 {
-  gboolean ret = G_SOURCE_REMOVE;
+  guint len;
+  guint i;
 
   g_assert (GDK_IS_FRAME_CLOCK (frame_clock));
-  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (timeline != NULL);
+
+  /*
+   * Animations added while dispatching are appended past @len and will
+   * get their first tick on the next frame. Animations stopped while
+   * dispatching leave a hole that is compacted afterwards.
+   */
+
+  timeline->dispatch_depth++;
 
-  if (animation->tween_handler)
+  len = timeline->animations->len;
+
+  for (i = 0; i < len; i++)
     {
+      PnlAnimation *animation = g_ptr_array_index (timeline->animations, i);
       gdouble offset;
 
+      if (animation == NULL)
+        continue;
+
       offset = pnl_animation_get_offset (animation, 0);
 
-      if (!(ret = pnl_animation_tick (animation, offset)))
+      if (!pnl_animation_tick (animation, offset))
         pnl_animation_stop (animation);
     }
 
-  return ret;
+  timeline->dispatch_depth--;
+
+  pnl_animation_timeline_compact (timeline);
 }
 
 
 static void
-pnl_animation_widget_after_paint_cb (GdkFrameClock *frame_clock,
-                                     PnlAnimation  *animation)
+pnl_animation_timeline_after_paint_cb (GdkFrameClock        *frame_clock,
+                                       PnlAnimationTimeline *timeline)
 {
   gint64 base_time;
   gint64 interval;
   gint64 next_frame_time;
-  gdouble offset;
+  guint len;
+  guint i;
 
   g_assert (GDK_IS_FRAME_CLOCK (frame_clock));
-  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (timeline != NULL);
 
   base_time = gdk_frame_clock_get_frame_time (frame_clock);
   gdk_frame_clock_get_refresh_info (frame_clock, base_time, &interval, &next_frame_time);
 
-  offset = pnl_animation_get_offset (animation, next_frame_time);
+  timeline->dispatch_depth++;
+
+  len = timeline->animations->len;
+
+  for (i = 0; i < len; i++)
+    {
+      PnlAnimation *animation = g_ptr_array_index (timeline->animations, i);
+      gdouble offset;
+
+      if (animation == NULL)
+        continue;
+
+      offset = pnl_animation_get_offset (animation, next_frame_time);
+
+      pnl_animation_tick (animation, offset);
+    }
+
+  timeline->dispatch_depth--;
+
+  pnl_animation_timeline_compact (timeline);
+}
+
+
+static PnlAnimationTimeline *
+pnl_animation_timeline_get (GdkFrameClock *frame_clock)
+{
+  PnlAnimationTimeline *timeline;
+
+  g_assert (GDK_IS_FRAME_CLOCK (frame_clock));
+
+  timeline = g_object_get_qdata (G_OBJECT (frame_clock), timeline_quark);
+
+  if (timeline == NULL)
+    {
+      timeline = g_slice_new0 (PnlAnimationTimeline);
+      timeline->frame_clock = frame_clock;
+      timeline->animations = g_ptr_array_new ();
+      g_object_set_qdata_full (G_OBJECT (frame_clock),
+                               timeline_quark,
+                               timeline,
+                               pnl_animation_timeline_free);
+    }
+
+  return timeline;
+}
+
+
+static void
+pnl_animation_timeline_add (PnlAnimationTimeline *timeline,
+                            PnlAnimation         *animation)
+{
+  g_assert (timeline != NULL);
+  g_assert (PNL_IS_ANIMATION (animation));
+
+  g_ptr_array_add (timeline->animations, animation);
+
+  if (timeline->update_handler == 0)
+    {
+      timeline->update_handler =
+        g_signal_connect (timeline->frame_clock,
+                          "update",
+                          G_CALLBACK (pnl_animation_timeline_update_cb),
+                          timeline);
+      timeline->after_paint_handler =
+        g_signal_connect (timeline->frame_clock,
+                          "after-paint",
+                          G_CALLBACK (pnl_animation_timeline_after_paint_cb),
+                          timeline);
+      gdk_frame_clock_begin_updating (timeline->frame_clock);
+    }
+}
+
+
+static void
+pnl_animation_timeline_remove (PnlAnimationTimeline *timeline,
+                               PnlAnimation         *animation)
+{
+  guint i;
+
+  g_assert (timeline != NULL);
+  g_assert (PNL_IS_ANIMATION (animation));
+
+  for (i = 0; i < timeline->animations->len; i++)
+    {
+      if (g_ptr_array_index (timeline->animations, i) == (gpointer)animation)
+        {
+          if (timeline->dispatch_depth > 0)
+            {
+              timeline->animations->pdata [i] = NULL;
+              timeline->needs_compact = TRUE;
+            }
+          else
+            {
+              g_ptr_array_remove_index_fast (timeline->animations, i);
+            }
+          break;
+        }
+    }
+
+  pnl_animation_timeline_compact (timeline);
+}
+
+
+/**
+ * pnl_animation_release_tween:
+ * @animation: (in): A #PnlAnimation.
+ * @pspec: (in): The #GParamSpec another animation is taking over.
+ *
+ * Drops the tween for @pspec from @animation because a newer animation
+ * is now driving the same property. If no tweens remain, @animation is
+ * stopped. When called from within the tick of @animation, the tween is
+ * only removed once the tick completes and stopping is deferred to the
+ * caller of pnl_animation_tick().
+ */
+static void
+pnl_animation_release_tween (PnlAnimation *animation,
+                             GParamSpec   *pspec)
+{
+  guint i;
+
+  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (pspec != NULL);
+
+  for (i = 0; i < animation->tweens->len; i++)
+    {
+      Tween *tween = &g_array_index (animation->tweens, Tween, i);
+
+      if (tween->pspec == pspec && !tween->released)
+        {
+          /*
+           * Removing the tween now would shift the array under the loop
+           * in pnl_animation_tick(), so only mark it while ticking.
+           */
+          if (animation->in_tick)
+            {
+              tween->released = TRUE;
+              animation->n_released++;
+            }
+          else
+            {
+              pnl_animation_clear_tween (tween);
+              g_array_remove_index (animation->tweens, i);
+            }
+          break;
+        }
+    }
+
+  if (animation->tweens->len == animation->n_released)
+    {
+      animation->superseded = TRUE;
+      if (!animation->in_tick)
+        pnl_animation_stop (animation);
+    }
+}
+
+/**
+ * pnl_animation_register:
+ * @animation: (in): A #PnlAnimation.
+ *
+ * Records @animation as the owner of each of its properties on the target.
+ * Any running animation that currently owns one of those properties has
+ * that property taken away, so only one animation writes a given property
+ * per frame. The new animation begins from the current value, so the
+ * transition continues smoothly from wherever the previous one left off.
+ */
+static void
+pnl_animation_register (PnlAnimation *animation)
+{
+  GHashTable *registry;
+  guint i;
+
+  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (G_IS_OBJECT (animation->target));
+
+  registry = g_object_get_qdata (animation->target, registry_quark);
+
+  if (registry == NULL)
+    {
+      registry = g_hash_table_new (NULL, NULL);
+      g_object_set_qdata_full (animation->target,
+                               registry_quark,
+                               registry,
+                               (GDestroyNotify)g_hash_table_unref);
+    }
+
+  for (i = 0; i < animation->tweens->len; i++)
+    {
+      Tween *tween = &g_array_index (animation->tweens, Tween, i);
+      PnlAnimation *previous;
+
+      previous = g_hash_table_lookup (registry, tween->pspec);
+
+      if (previous != NULL && previous != animation)
+        pnl_animation_release_tween (previous, tween->pspec);
+
+      g_hash_table_insert (registry, tween->pspec, animation);
+    }
+}
+
+
+/**
+ * pnl_animation_unregister:
+ * @animation: (in): A #PnlAnimation.
+ *
+ * Removes the properties still owned by @animation from the registry
+ * of the target.
+ */
+static void
+pnl_animation_unregister (PnlAnimation *animation)
+{
+  GHashTable *registry;
+  guint i;
+
+  g_assert (PNL_IS_ANIMATION (animation));
+  g_assert (G_IS_OBJECT (animation->target));
+
+  registry = g_object_get_qdata (animation->target, registry_quark);
+
+  if (registry == NULL)
+    return;
+
+  for (i = 0; i < animation->tweens->len; i++)
+    {
+      Tween *tween = &g_array_index (animation->tweens, Tween, i);
 
-  pnl_animation_tick (animation, offset);
+      if (g_hash_table_lookup (registry, tween->pspec) == animation)
+        g_hash_table_remove (registry, tween->pspec);
+    }
 }
 
 
@@ -602,31 +1093,27 @@ pnl_animation_widget_after_paint_cb (GdkFrameClock *frame_clock,
  * Start the animation. When the animation stops, the internal reference will
  * be dropped and the animation may be finalized.
  *
+ * Any other running animation of the same properties on the same target
+ * stops animating those properties, and the new animation begins from
+ * their current values.
+ *
  * Side effects: None.
  */
 void
 pnl_animation_start (PnlAnimation *animation)
 {
   g_return_if_fail (PNL_IS_ANIMATION (animation));
-  g_return_if_fail (!animation->tween_handler);
+  g_return_if_fail (!pnl_animation_is_running (animation));
 
   g_object_ref_sink (animation);
+  pnl_animation_register (animation);
   pnl_animation_load_begin_values (animation);
 
   if (animation->frame_clock)
     {
       animation->begin_msec = gdk_frame_clock_get_frame_time (animation->frame_clock) / 1000UL;
-      animation->tween_handler =
-        g_signal_connect (animation->frame_clock,
-                          "update",
-                          G_CALLBACK (pnl_animation_widget_tick_cb),
-                          animation);
-      animation->after_paint_handler =
-        g_signal_connect (animation->frame_clock,
-                          "after-paint",
-                          G_CALLBACK (pnl_animation_widget_after_paint_cb),
-                          animation);
-      gdk_frame_clock_begin_updating (animation->frame_clock);
+      animation->timeline = pnl_animation_timeline_get (animation->frame_clock);
+      pnl_animation_timeline_add (animation->timeline, animation);
     }
   else
     {
@@ -670,20 +1157,21 @@ pnl_animation_stop (PnlAnimation *animation)
 {
   g_return_if_fail (PNL_IS_ANIMATION (animation));
 
-  if (animation->tween_handler)
+  if (pnl_animation_is_running (animation))
     {
-      if (animation->frame_clock)
+      if (animation->timeline != NULL)
         {
-          gdk_frame_clock_end_updating (animation->frame_clock);
-          g_signal_handler_disconnect (animation->frame_clock, animation->tween_handler);
-          g_signal_handler_disconnect (animation->frame_clock, animation->after_paint_handler);
-          animation->tween_handler = 0;
+          PnlAnimationTimeline *timeline = animation->timeline;
+
+          animation->timeline = NULL;
+          pnl_animation_timeline_remove (timeline, animation);
         }
       else
         {
           g_source_remove (animation->tween_handler);
           animation->tween_handler = 0;
         }
+      pnl_animation_unregister (animation);
       pnl_animation_unload_begin_values (animation);
       pnl_animation_notify (animation);
       g_object_unref (animation);
@@ -715,7 +1203,7 @@ pnl_animation_add_property (PnlAnimation *animation,
   g_return_if_fail (value != NULL);
   g_return_if_fail (value->g_type);
   g_return_if_fail (animation->target);
-  g_return_if_fail (!animation->tween_handler);
+  g_return_if_fail (!pnl_animation_is_running (animation));
 
   type = G_TYPE_FROM_INSTANCE (animation->target);
   tween.is_child = !g_type_is_a (type, pspec->owner_type);
@@ -732,7 +1220,9 @@ pnl_animation_add_property (PnlAnimation *animation,
   tween.pspec = g_param_spec_ref (pspec);
   g_value_init (&tween.begin, pspec->value_type);
   g_value_init (&tween.end, pspec->value_type);
+  g_value_init (&tween.value, pspec->value_type);
   g_value_copy (value, &tween.end);
+  tween.setter = pnl_animation_find_setter (animation, &tween);
   g_array_append_val (animation->tweens, tween);
 }
 
@@ -775,9 +1265,7 @@ pnl_animation_finalize (GObject *object)
   for (i = 0; i < self->tweens->len; i++)
     {
       tween = &g_array_index (self->tweens, Tween, i);
-      g_value_unset (&tween->begin);
-      g_value_unset (&tween->end);
-      g_param_spec_unref (tween->pspec);
+      pnl_animation_clear_tween (tween);
     }
 
   g_array_unref (self->tweens);
@@ -842,6 +1330,8 @@ pnl_animation_class_init (PnlAnimationClass *klass)
   const gchar *slow_down_factor_env;
 
   debug = !!g_getenv ("PNL_ANIMATION_DEBUG");
+  timeline_quark = g_quark_from_static_string ("PNL_ANIMATION_TIMELINE");
+  registry_quark = g_quark_from_static_string ("PNL_ANIMATION_REGISTRY");
   slow_down_factor_env = g_getenv ("PNL_ANIMATION_SLOW_DOWN_FACTOR");
 
   if (slow_down_factor_env)
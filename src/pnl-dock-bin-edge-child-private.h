@@ -30,6 +30,9 @@ G_DECLARE_FINAL_TYPE (PnlDockBinEdgeChild, pnl_dock_bin_edge_child, PNL, DOCK_BI
 gint pnl_dock_bin_edge_child_get_position (PnlDockBinEdgeChild *self);
 void pnl_dock_bin_edge_child_set_position (PnlDockBinEdgeChild *self,
                                            gint                  position);
+gboolean pnl_dock_bin_edge_child_get_dragging (PnlDockBinEdgeChild *self);
+void     pnl_dock_bin_edge_child_set_dragging (PnlDockBinEdgeChild *self,
+                                               gboolean             dragging);
 
 G_END_DECLS
 
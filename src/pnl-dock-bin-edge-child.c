@@ -33,6 +33,13 @@ struct _PnlDockBinEdgeChild
 {
   GtkBin parent;
   gint   position;
+
+  /*
+   * While the edge handle is being dragged, the PnlDockBin decides our
+   * size. We only request our minimum so that the revealer allocates us
+   * exactly what we are given, without needing a resize for each step.
+   */
+  guint  dragging : 1;
 };
 
 G_DEFINE_TYPE (PnlDockBinEdgeChild, pnl_dock_bin_edge_child, GTK_TYPE_BIN)
@@ -98,14 +105,14 @@ pnl_dock_bin_edge_child_get_preferred_height (GtkWidget *widget,
 
   parent = gtk_widget_get_parent (widget);
 
-  if (self->position != 0 && PNL_IS_DOCK_BIN_EDGE (parent))
+  if ((self->dragging || self->position != 0) && PNL_IS_DOCK_BIN_EDGE (parent))
     {
       GtkPositionType edge;
 
       edge = pnl_dock_bin_edge_get_edge (PNL_DOCK_BIN_EDGE (parent));
 
       if (edge == GTK_POS_TOP || edge == GTK_POS_BOTTOM)
-        *nat_height = MAX (*min_height, self->position);
+        *nat_height = self->dragging ? *min_height : MAX (*min_height, self->position);
     }
 }
 
@@ -125,14 +132,14 @@ pnl_dock_bin_edge_child_get_preferred_width (GtkWidget *widget,
 
   parent = gtk_widget_get_parent (widget);
 
-  if (self->position != 0 && PNL_IS_DOCK_BIN_EDGE (parent))
+  if ((self->dragging || self->position != 0) && PNL_IS_DOCK_BIN_EDGE (parent))
     {
       GtkPositionType edge;
 
       edge = pnl_dock_bin_edge_get_edge (PNL_DOCK_BIN_EDGE (parent));
 
       if (edge == GTK_POS_LEFT || edge == GTK_POS_RIGHT)
-        *nat_width = MAX (*min_width, self->position);
+        *nat_width = self->dragging ? *min_width : MAX (*min_width, self->position);
     }
 }
 
@@ -255,3 +262,26 @@ pnl_dock_bin_edge_child_set_position (PnlDockBinEdgeChild *self,
       gtk_widget_queue_resize (GTK_WIDGET (self));
     }
 }
+
+gboolean
+pnl_dock_bin_edge_child_get_dragging (PnlDockBinEdgeChild *self)
+{
+  g_return_val_if_fail (PNL_IS_DOCK_BIN_EDGE_CHILD (self), FALSE);
+
+  return self->dragging;
+}
+
+void
+pnl_dock_bin_edge_child_set_dragging (PnlDockBinEdgeChild *self,
+                                      gboolean             dragging)
+{
+  g_return_if_fail (PNL_IS_DOCK_BIN_EDGE_CHILD (self));
+
+  dragging = !!dragging;
+
+  if (dragging != self->dragging)
+    {
+      self->dragging = dragging;
+      gtk_widget_queue_resize (GTK_WIDGET (self));
+    }
+}
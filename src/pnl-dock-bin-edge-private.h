@@ -33,6 +33,8 @@ void            pnl_dock_bin_edge_set_edge     (PnlDockBinEdge  *self,
 gint            pnl_dock_bin_edge_get_position (PnlDockBinEdge  *self);
 void            pnl_dock_bin_edge_set_position (PnlDockBinEdge  *self,
                                                 gint             position);
+void            pnl_dock_bin_edge_set_dragging (PnlDockBinEdge  *self,
+                                                gboolean         dragging);
 
 G_END_DECLS
 
@@ -133,6 +133,27 @@ pnl_dock_bin_edge_set_position (PnlDockBinEdge *self,
   g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_POSITION]);
 }
 
+/*
+ * pnl_dock_bin_edge_set_dragging:
+ *
+ * While dragging, the PnlDockBin sizes the edge directly from the drag
+ * offset and only reallocates itself. The position is not clamped to the
+ * allocation during that time and is committed when the drag completes.
+ */
+void
+pnl_dock_bin_edge_set_dragging (PnlDockBinEdge *self,
+                                gboolean        dragging)
+{
+  GtkWidget *child;
+
+  g_return_if_fail (PNL_IS_DOCK_BIN_EDGE (self));
+
+  child = gtk_bin_get_child (GTK_BIN (self));
+  g_assert (PNL_IS_DOCK_BIN_EDGE_CHILD (child));
+
+  pnl_dock_bin_edge_child_set_dragging (PNL_DOCK_BIN_EDGE_CHILD (child), dragging);
+}
+
 static void
 pnl_dock_bin_edge_add (GtkContainer *container,
                    GtkWidget    *widget)
@@ -154,17 +175,21 @@ pnl_dock_bin_edge_size_allocate (GtkWidget     *widget,
                              GtkAllocation *allocation)
 {
   PnlDockBinEdge *self = (PnlDockBinEdge *)widget;
+  GtkWidget *child;
   gint position;
 
   g_assert (PNL_IS_DOCK_BIN_EDGE (self));
   g_assert (allocation != NULL);
 
+  child = gtk_bin_get_child (GTK_BIN (self));
+
   if (self->edge == GTK_POS_LEFT || self->edge == GTK_POS_RIGHT)
     position = allocation->width;
   else
     position = allocation->height;
 
-  if (gtk_revealer_get_reveal_child (GTK_REVEALER (self)) &&
+  if (!pnl_dock_bin_edge_child_get_dragging (PNL_DOCK_BIN_EDGE_CHILD (child)) &&
+      gtk_revealer_get_reveal_child (GTK_REVEALER (self)) &&
       gtk_revealer_get_child_revealed (GTK_REVEALER (self)) &&
       (position < pnl_dock_bin_edge_get_position (self)))
     pnl_dock_bin_edge_set_position (self, position);
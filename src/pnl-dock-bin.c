@@ -21,10 +21,14 @@
 #include "pnl-dock-bin.h"
 #include "pnl-dock-bin-edge-private.h"
 #include "pnl-dock-item.h"
+#include "pnl-dock-private.h"
+#include "pnl-trace-private.h"
 
 #define HANDLE_WIDTH  10
 #define HANDLE_HEIGHT 10
 
+#define DND_EDGE_ZONE_SIZE 50
+
 typedef enum
 {
   PNL_DOCK_BIN_CHILD_LEFT   = GTK_POS_LEFT,
@@ -73,17 +77,25 @@ typedef struct
   /*
    * Priority child property used to alter which child is
    * dominant in each slice stage. See
-   * pnl_dock_bin_get_children_preferred_width() for more information
+   * pnl_dock_bin_update_slices() for more information
    * on how the slicing is performed.
    */
   gint priority;
 
   /*
-   * Cached size request used during size allocation.
+   * The size request of the child widget itself, cached from the last
+   * time we were measured. See pnl_dock_bin_measure_children().
    */
   GtkRequisition min_req;
   GtkRequisition nat_req;
 
+  /*
+   * The combined size request of this child and every child after it in
+   * priority order. See pnl_dock_bin_update_slices().
+   */
+  GtkRequisition slice_min_req;
+  GtkRequisition slice_nat_req;
+
   /*
    * If we animated in this panel during DnD, we want to restore
    * it unless we dragged onto this panel.
@@ -114,11 +126,39 @@ typedef struct
    */
   PnlDockBinChild *drag_child;
 
+  /*
+   * Pan events can arrive much faster than we draw frames. The latest
+   * edge position is stashed here and applied from a tick callback during
+   * the frame clock update phase, so we relayout at most once per frame.
+   */
+  gint drag_pending_position;
+  guint drag_tick_handler;
+  guint drag_n_events;
+  guint drag_n_frames;
+
   /*
    * We need to track the position during a DnD request. We can use this
    * to highlight the area where the drop will occur.
    */
   guint in_dnd : 1;
+
+  /*
+   * If the cached child requests are usable for size allocation. They are
+   * refreshed every time GTK+ measures us, and cleared when we change our
+   * children and queue a resize (see pnl_dock_bin_queue_resize()).
+   */
+  guint width_cache_valid : 1;
+  guint height_cache_valid : 1;
+
+  /*
+   * The drop zones are computed once per allocation and reused for every
+   * motion event of a drag. dnd_zone is the zone currently highlighted,
+   * or LAST_PNL_DOCK_BIN_CHILD if there is none.
+   */
+  guint dnd_zones_valid : 1;
+  GdkRectangle dnd_zones[LAST_PNL_DOCK_BIN_CHILD];
+  PnlDockBinChildType dnd_zone;
+
   gint dnd_drag_x;
   gint dnd_drag_y;
 } PnlDockBinPrivate;
@@ -150,6 +190,7 @@ enum {
 };
 
 static GParamSpec *child_properties [LAST_CHILD_PROP];
+static gboolean debug_drag;
 
 static gboolean
 map_boolean_to_variant (GBinding     *binding,
@@ -306,6 +347,20 @@ pnl_dock_bin_get_action_for_type (PnlDockBin          *self,
   return g_action_map_lookup_action (G_ACTION_MAP (priv->actions), name);
 }
 
+static void
+pnl_dock_bin_queue_resize (PnlDockBin *self)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+
+  /* Our children changed, so the cached requests can no longer be used. */
+  priv->width_cache_valid = FALSE;
+  priv->height_cache_valid = FALSE;
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
+
 static void
 pnl_dock_bin_add (GtkContainer *container,
                   GtkWidget    *widget)
@@ -340,7 +395,7 @@ pnl_dock_bin_add (GtkContainer *container,
 
   pnl_dock_bin_update_focus_chain (self);
 
-  gtk_widget_queue_resize (GTK_WIDGET (self));
+  pnl_dock_bin_queue_resize (self);
 }
 
 static void
@@ -357,7 +412,7 @@ pnl_dock_bin_remove (GtkContainer *container,
   gtk_widget_unparent (child->widget);
   g_clear_object (&child->widget);
 
-  gtk_widget_queue_resize (GTK_WIDGET (self));
+  pnl_dock_bin_queue_resize (self);
 }
 
 static void
@@ -383,27 +438,83 @@ pnl_dock_bin_forall (GtkContainer *container,
 }
 
 static void
-pnl_dock_bin_get_children_preferred_width (PnlDockBin      *self,
-                                           PnlDockBinChild *children,
-                                           gint             n_children,
-                                           gint            *min_width,
-                                           gint            *nat_width)
+pnl_dock_bin_measure_children (PnlDockBin     *self,
+                               GtkOrientation  orientation)
 {
   PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
-  PnlDockBinChild *child = children;
-  gint child_min_width = 0;
-  gint child_nat_width = 0;
-  gint neighbor_min_width = 0;
-  gint neighbor_nat_width = 0;
+  guint i;
 
   g_assert (PNL_IS_DOCK_BIN (self));
-  g_assert (children != NULL);
-  g_assert (n_children > 0);
-  g_assert (min_width != NULL);
-  g_assert (nat_width != NULL);
 
-  *min_width = 0;
-  *nat_width = 0;
+  /*
+   * GTK+ only calls our measure vfuncs after something in our subtree has
+   * queued a resize, and each child widget caches its own request, so an
+   * unchanged child is cheap to ask here. We keep the result so that size
+   * allocation does not need to measure anything again.
+   */
+
+  for (i = 0; i < G_N_ELEMENTS (priv->children); i++)
+    {
+      PnlDockBinChild *child = &priv->children [i];
+      gint min_size = 0;
+      gint nat_size = 0;
+
+      if (orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          if (child->widget != NULL)
+            gtk_widget_get_preferred_width (child->widget, &min_size, &nat_size);
+          child->min_req.width = min_size;
+          child->nat_req.width = nat_size;
+        }
+      else
+        {
+          if (child->widget != NULL)
+            gtk_widget_get_preferred_height (child->widget, &min_size, &nat_size);
+          child->min_req.height = min_size;
+          child->nat_req.height = nat_size;
+        }
+    }
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    priv->width_cache_valid = TRUE;
+  else
+    priv->height_cache_valid = TRUE;
+}
+
+static void
+pnl_dock_bin_get_child_request (PnlDockBin            *self,
+                                const PnlDockBinChild *child,
+                                GtkRequisition        *min_req,
+                                GtkRequisition        *nat_req)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+  g_assert (child != NULL);
+  g_assert (min_req != NULL);
+  g_assert (nat_req != NULL);
+
+  *min_req = child->min_req;
+  *nat_req = child->nat_req;
+
+  if (child == priv->drag_child)
+    {
+      nat_req->width = MAX (min_req->width,
+                            child->drag_begin_position + child->drag_offset);
+      nat_req->height = MAX (min_req->height,
+                             child->drag_begin_position + child->drag_offset);
+    }
+}
+
+static void
+pnl_dock_bin_update_slices (PnlDockBin *self)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  GtkRequisition neighbor_min = { 0 };
+  GtkRequisition neighbor_nat = { 0 };
+  guint i;
+
+  g_assert (PNL_IS_DOCK_BIN (self));
 
   /*
    * We have a fairly simple rule for deducing the size request of
@@ -439,54 +550,53 @@ pnl_dock_bin_get_children_preferred_width (PnlDockBin      *self,
    * Both 2 and 4, will always negotiate their widths with the next
    * child.
    *
-   * This allows us to make a fairly simple recursive function to
-   * size ourselves and then call again with the next child, working our
-   * way down to 5 (the center widget).
+   * Heights work the same way, but the negotiated/additive operations
+   * are switched between the left/right and top/bottom.
    *
-   * At this point, we walk back up the recursive-stack and do our
-   * adding or negotiating.
+   * We walk from 5 (the center widget, which is always last) back to the
+   * most dominant child, so each slice only needs the cached request of
+   * its own child and the slice that follows it.
    */
 
-  if (child->widget != NULL)
-    gtk_widget_get_preferred_width (child->widget, &child_min_width, &child_nat_width);
+  for (i = G_N_ELEMENTS (priv->children); i > 0; i--)
+    {
+      PnlDockBinChild *child = &priv->children [i - 1];
+      GtkRequisition child_min;
+      GtkRequisition child_nat;
 
-  if (child == priv->drag_child)
-    child_nat_width = MAX (child_min_width,
-                           child->drag_begin_position + child->drag_offset);
+      pnl_dock_bin_get_child_request (self, child, &child_min, &child_nat);
 
-  if (n_children > 1)
-    pnl_dock_bin_get_children_preferred_width (self,
-                                           &children [1],
-                                           n_children - 1,
-                                           &neighbor_min_width,
-                                           &neighbor_nat_width);
+      switch (child->type)
+        {
+        case PNL_DOCK_BIN_CHILD_LEFT:
+        case PNL_DOCK_BIN_CHILD_RIGHT:
+          child->slice_min_req.width = child_min.width + neighbor_min.width;
+          child->slice_nat_req.width = child_nat.width + neighbor_nat.width;
+          child->slice_min_req.height = MAX (child_min.height, neighbor_min.height);
+          child->slice_nat_req.height = MAX (child_nat.height, neighbor_nat.height);
+          break;
 
-  switch (child->type)
-    {
-    case PNL_DOCK_BIN_CHILD_LEFT:
-    case PNL_DOCK_BIN_CHILD_RIGHT:
-      *min_width = (child_min_width + neighbor_min_width);
-      *nat_width = (child_nat_width + neighbor_nat_width);
-      break;
+        case PNL_DOCK_BIN_CHILD_TOP:
+        case PNL_DOCK_BIN_CHILD_BOTTOM:
+          child->slice_min_req.width = MAX (child_min.width, neighbor_min.width);
+          child->slice_nat_req.width = MAX (child_nat.width, neighbor_nat.width);
+          child->slice_min_req.height = child_min.height + neighbor_min.height;
+          child->slice_nat_req.height = child_nat.height + neighbor_nat.height;
+          break;
 
-    case PNL_DOCK_BIN_CHILD_TOP:
-    case PNL_DOCK_BIN_CHILD_BOTTOM:
-      *min_width = MAX (child_min_width, neighbor_min_width);
-      *nat_width = MAX (child_nat_width, neighbor_nat_width);
-      break;
+        case PNL_DOCK_BIN_CHILD_CENTER:
+          child->slice_min_req = child_min;
+          child->slice_nat_req = child_min;
+          break;
 
-    case PNL_DOCK_BIN_CHILD_CENTER:
-      *min_width = child_min_width;
-      *nat_width = child_min_width;
-      break;
+        case LAST_PNL_DOCK_BIN_CHILD:
+        default:
+          g_assert_not_reached ();
+        }
 
-    case LAST_PNL_DOCK_BIN_CHILD:
-    default:
-      g_assert_not_reached ();
+      neighbor_min = child->slice_min_req;
+      neighbor_nat = child->slice_nat_req;
     }
-
-  child->min_req.width = *min_width;
-  child->nat_req.width = *nat_width;
 }
 
 static void
@@ -496,87 +606,19 @@ pnl_dock_bin_get_preferred_width (GtkWidget *widget,
 {
   PnlDockBin *self = (PnlDockBin *)widget;
   PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_DOCK_BIN (self));
   g_assert (min_width != NULL);
   g_assert (nat_width != NULL);
 
-  pnl_dock_bin_get_children_preferred_width (self,
-                                             priv->children,
-                                             G_N_ELEMENTS (priv->children),
-                                             min_width,
-                                             nat_width);
-}
-
-static void
-pnl_dock_bin_get_children_preferred_height (PnlDockBin      *self,
-                                            PnlDockBinChild *children,
-                                            gint             n_children,
-                                            gint            *min_height,
-                                            gint            *nat_height)
-{
-  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
-  PnlDockBinChild *child = children;
-  gint child_min_height = 0;
-  gint child_nat_height = 0;
-  gint neighbor_min_height = 0;
-  gint neighbor_nat_height = 0;
-
-  g_assert (PNL_IS_DOCK_BIN (self));
-  g_assert (children != NULL);
-  g_assert (n_children > 0);
-  g_assert (min_height != NULL);
-  g_assert (nat_height != NULL);
-
-  *min_height = 0;
-  *nat_height = 0;
-
-  /*
-   * See pnl_dock_bin_get_children_preferred_width() for more information on
-   * how this works. This works just like that but the negotiated/additive
-   * operations are switched between the left/right and top/bottom.
-   */
-
-  if (child->widget != NULL)
-    gtk_widget_get_preferred_height (child->widget, &child_min_height, &child_nat_height);
-
-  if (child == priv->drag_child)
-    child_nat_height = MAX (child_min_height,
-                            child->drag_begin_position + child->drag_offset);
+  pnl_dock_bin_measure_children (self, GTK_ORIENTATION_HORIZONTAL);
+  pnl_dock_bin_update_slices (self);
 
-  if (n_children > 1)
-    pnl_dock_bin_get_children_preferred_height (self,
-                                                &children [1],
-                                                n_children - 1,
-                                                &neighbor_min_height,
-                                                &neighbor_nat_height);
+  *min_width = priv->children [0].slice_min_req.width;
+  *nat_width = priv->children [0].slice_nat_req.width;
 
-  switch (child->type)
-    {
-    case PNL_DOCK_BIN_CHILD_LEFT:
-    case PNL_DOCK_BIN_CHILD_RIGHT:
-      *min_height = MAX (child_min_height, neighbor_min_height);
-      *nat_height = MAX (child_nat_height, neighbor_nat_height);
-      break;
-
-    case PNL_DOCK_BIN_CHILD_TOP:
-    case PNL_DOCK_BIN_CHILD_BOTTOM:
-      *min_height = (child_min_height + neighbor_min_height);
-      *nat_height = (child_nat_height + neighbor_nat_height);
-      break;
-
-    case PNL_DOCK_BIN_CHILD_CENTER:
-      *min_height = child_min_height;
-      *nat_height = child_min_height;
-      break;
-
-    case LAST_PNL_DOCK_BIN_CHILD:
-    default:
-      g_assert_not_reached ();
-    }
-
-  child->min_req.height = *min_height;
-  child->nat_req.height = *nat_height;
+  PNL_TRACE_END ("PnlDockBin.get_preferred_width");
 }
 
 static void
@@ -586,16 +628,19 @@ pnl_dock_bin_get_preferred_height (GtkWidget *widget,
 {
   PnlDockBin *self = (PnlDockBin *)widget;
   PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_DOCK_BIN (self));
   g_assert (min_height != NULL);
   g_assert (nat_height != NULL);
 
-  pnl_dock_bin_get_children_preferred_height (self,
-                                              priv->children,
-                                              G_N_ELEMENTS (priv->children),
-                                              min_height,
-                                              nat_height);
+  pnl_dock_bin_measure_children (self, GTK_ORIENTATION_VERTICAL);
+  pnl_dock_bin_update_slices (self);
+
+  *min_height = priv->children [0].slice_min_req.height;
+  *nat_height = priv->children [0].slice_nat_req.height;
+
+  PNL_TRACE_END ("PnlDockBin.get_preferred_height");
 }
 
 static void
@@ -627,60 +672,50 @@ pnl_dock_bin_negotiate_size (PnlDockBin           *self,
 }
 
 static void
-pnl_dock_bin_child_size_allocate (PnlDockBin      *self,
-                                  PnlDockBinChild *children,
-                                  gint             n_children,
-                                  GtkAllocation   *allocation)
+pnl_dock_bin_child_size_allocate (PnlDockBin    *self,
+                                  GtkAllocation *allocation)
 {
-  PnlDockBinChild *child = children;
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  guint i;
 
   g_assert (PNL_IS_DOCK_BIN (self));
-  g_assert (children != NULL);
-  g_assert (n_children >= 1);
   g_assert (allocation != NULL);
 
-  if (n_children == 1)
-    {
-      g_assert (child->type == PNL_DOCK_BIN_CHILD_CENTER);
-
-      if (child->widget != NULL && gtk_widget_get_visible (child->widget))
-        gtk_widget_size_allocate (child->widget, allocation);
-
-      return;
-    }
+  /*
+   * Each child takes its slice off of @allocation in priority order,
+   * negotiating against the cached slice request of the children that
+   * follow it. The center widget gets whatever is left.
+   */
 
-  if (child->widget != NULL && gtk_widget_get_visible (child->widget))
+  for (i = 0; i < G_N_ELEMENTS (priv->children); i++)
     {
+      PnlDockBinChild *child = &priv->children [i];
       GtkAllocation child_alloc = { 0 };
       GtkAllocation handle_alloc = { 0 };
-      GtkRequisition neighbor_min = { 0 };
-      GtkRequisition neighbor_nat = { 0 };
-
-      pnl_dock_bin_get_children_preferred_height (self, child, 1,
-                                                  &child->min_req.height,
-                                                  &child->nat_req.height);
-      pnl_dock_bin_get_children_preferred_width (self, child, 1,
-                                                 &child->min_req.width,
-                                                 &child->nat_req.width);
-
-      pnl_dock_bin_get_children_preferred_height (self,
-                                                  &children [1],
-                                                  n_children - 1,
-                                                  &neighbor_min.height,
-                                                  &neighbor_nat.height);
-
-      pnl_dock_bin_get_children_preferred_width (self,
-                                                 &children [1],
-                                                 n_children - 1,
-                                                 &neighbor_min.width,
-                                                 &neighbor_nat.width);
+      GtkRequisition child_min;
+      GtkRequisition child_nat;
+
+      if (i == G_N_ELEMENTS (priv->children) - 1)
+        {
+          g_assert (child->type == PNL_DOCK_BIN_CHILD_CENTER);
+
+          if (child->widget != NULL && gtk_widget_get_visible (child->widget))
+            gtk_widget_size_allocate (child->widget, allocation);
+
+          break;
+        }
+
+      if (child->widget == NULL || !gtk_widget_get_visible (child->widget))
+        continue;
+
+      pnl_dock_bin_get_child_request (self, child, &child_min, &child_nat);
 
       pnl_dock_bin_negotiate_size (self,
                                    allocation,
-                                   &child->min_req,
-                                   &child->nat_req,
-                                   &neighbor_min,
-                                   &neighbor_nat,
+                                   &child_min,
+                                   &child_nat,
+                                   &priv->children [i + 1].slice_min_req,
+                                   &priv->children [i + 1].slice_nat_req,
                                    &child_alloc);
 
       switch (child->type)
@@ -756,8 +791,6 @@ pnl_dock_bin_child_size_allocate (PnlDockBin      *self,
 
       gtk_widget_size_allocate (child->widget, &child_alloc);
     }
-
-  pnl_dock_bin_child_size_allocate (self, &children [1], n_children - 1, allocation);
 }
 
 static void
@@ -767,16 +800,27 @@ pnl_dock_bin_size_allocate (GtkWidget     *widget,
   PnlDockBin *self = (PnlDockBin *)widget;
   PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
   guint i;
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_DOCK_BIN (self));
   g_assert (allocation != NULL);
 
   GTK_WIDGET_CLASS (pnl_dock_bin_parent_class)->size_allocate (widget, allocation);
 
-  pnl_dock_bin_child_size_allocate (self,
-                                    priv->children,
-                                    G_N_ELEMENTS (priv->children),
-                                    allocation);
+  /*
+   * We are normally measured right before being allocated, but make sure
+   * we have a cached request for each orientation in case we were not.
+   */
+  if (!priv->width_cache_valid)
+    pnl_dock_bin_measure_children (self, GTK_ORIENTATION_HORIZONTAL);
+  if (!priv->height_cache_valid)
+    pnl_dock_bin_measure_children (self, GTK_ORIENTATION_VERTICAL);
+
+  pnl_dock_bin_update_slices (self);
+
+  pnl_dock_bin_child_size_allocate (self, allocation);
+
+  priv->dnd_zones_valid = FALSE;
 
   /*
    * Hide all of the handle input windows that should be hidden
@@ -796,6 +840,167 @@ pnl_dock_bin_size_allocate (GtkWidget     *widget,
             gdk_window_hide (child->handle);
         }
     }
+
+  PNL_TRACE_END ("PnlDockBin.size_allocate");
+}
+
+static void
+pnl_dock_bin_update_dnd_zones (PnlDockBin *self)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  GtkAllocation allocation;
+  GdkRectangle *zones = priv->dnd_zones;
+  PnlDockBinChild *child;
+  gint strip_width;
+  gint strip_height;
+  guint i;
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+
+  gtk_widget_get_allocation (GTK_WIDGET (self), &allocation);
+
+  /*
+   * Edges that are not revealed still get a thin strip along their side
+   * of the dock so that they can be dropped onto (and revealed).
+   */
+  strip_width = MIN (DND_EDGE_ZONE_SIZE, allocation.width / 4);
+  strip_height = MIN (DND_EDGE_ZONE_SIZE, allocation.height / 4);
+
+  zones [PNL_DOCK_BIN_CHILD_LEFT] = (GdkRectangle) { 0, 0, strip_width, allocation.height };
+  zones [PNL_DOCK_BIN_CHILD_RIGHT] = (GdkRectangle) { allocation.width - strip_width, 0, strip_width, allocation.height };
+  zones [PNL_DOCK_BIN_CHILD_TOP] = (GdkRectangle) { 0, 0, allocation.width, strip_height };
+  zones [PNL_DOCK_BIN_CHILD_BOTTOM] = (GdkRectangle) { 0, allocation.height - strip_height, allocation.width, strip_height };
+  zones [PNL_DOCK_BIN_CHILD_CENTER] = (GdkRectangle) { 0, 0, allocation.width, allocation.height };
+
+  for (i = 0; i < LAST_PNL_DOCK_BIN_CHILD; i++)
+    {
+      GtkAllocation child_alloc;
+
+      child = pnl_dock_bin_get_child_typed (self, i);
+
+      if (child->widget == NULL || !gtk_widget_get_visible (child->widget))
+        continue;
+
+      if (i != PNL_DOCK_BIN_CHILD_CENTER &&
+          !(PNL_IS_DOCK_BIN_EDGE (child->widget) &&
+            gtk_revealer_get_reveal_child (GTK_REVEALER (child->widget))))
+        continue;
+
+      gtk_widget_get_allocation (child->widget, &child_alloc);
+
+      if (child_alloc.width <= 0 || child_alloc.height <= 0)
+        continue;
+
+      /* We have no window, so translate into our own coordinates. */
+      zones [i].x = child_alloc.x - allocation.x;
+      zones [i].y = child_alloc.y - allocation.y;
+      zones [i].width = child_alloc.width;
+      zones [i].height = child_alloc.height;
+    }
+
+  priv->dnd_zones_valid = TRUE;
+}
+
+static PnlDockBinChildType
+pnl_dock_bin_get_dnd_zone (PnlDockBin *self,
+                           gint        x,
+                           gint        y)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  guint i;
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+
+  if (!priv->dnd_zones_valid)
+    pnl_dock_bin_update_dnd_zones (self);
+
+  /*
+   * Edges are checked before the center so that their strips win where
+   * they overlap the center child. There are only ever five zones.
+   */
+  for (i = 0; i < LAST_PNL_DOCK_BIN_CHILD; i++)
+    {
+      const GdkRectangle *zone = &priv->dnd_zones [i];
+
+      if (x >= zone->x && x < zone->x + zone->width &&
+          y >= zone->y && y < zone->y + zone->height)
+        return i;
+    }
+
+  return LAST_PNL_DOCK_BIN_CHILD;
+}
+
+static void
+pnl_dock_bin_set_dnd_zone (PnlDockBin          *self,
+                           PnlDockBinChildType  zone)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  const GdkRectangle *area;
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+  g_assert (zone <= LAST_PNL_DOCK_BIN_CHILD);
+
+  if (zone == priv->dnd_zone)
+    return;
+
+  /* Only damage the previous and the new highlight. */
+
+  if (priv->dnd_zone != LAST_PNL_DOCK_BIN_CHILD)
+    {
+      area = &priv->dnd_zones [priv->dnd_zone];
+      gtk_widget_queue_draw_area (GTK_WIDGET (self), area->x, area->y, area->width, area->height);
+    }
+
+  priv->dnd_zone = zone;
+
+  if (zone != LAST_PNL_DOCK_BIN_CHILD)
+    {
+      area = &priv->dnd_zones [zone];
+      gtk_widget_queue_draw_area (GTK_WIDGET (self), area->x, area->y, area->width, area->height);
+    }
+}
+
+static gboolean
+pnl_dock_bin_draw (GtkWidget *widget,
+                   cairo_t   *cr)
+{
+  PnlDockBin *self = (PnlDockBin *)widget;
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+  gboolean ret;
+  PNL_TRACE_BEGIN;
+
+  ret = GTK_WIDGET_CLASS (pnl_dock_bin_parent_class)->draw (widget, cr);
+
+  if (priv->dnd_zone != LAST_PNL_DOCK_BIN_CHILD)
+    {
+      GtkStyleContext *style_context;
+      const GdkRectangle *area;
+      GdkRGBA color;
+
+      if (!priv->dnd_zones_valid)
+        pnl_dock_bin_update_dnd_zones (self);
+
+      area = &priv->dnd_zones [priv->dnd_zone];
+      style_context = gtk_widget_get_style_context (widget);
+
+      if (!gtk_style_context_lookup_color (style_context, "theme_selected_bg_color", &color))
+        gdk_rgba_parse (&color, "#4a90d9");
+
+      cairo_save (cr);
+      gdk_cairo_rectangle (cr, area);
+      color.alpha = 0.25;
+      gdk_cairo_set_source_rgba (cr, &color);
+      cairo_fill_preserve (cr);
+      color.alpha = 1.0;
+      gdk_cairo_set_source_rgba (cr, &color);
+      cairo_set_line_width (cr, 1.0);
+      cairo_stroke (cr);
+      cairo_restore (cr);
+    }
+
+  PNL_TRACE_END ("PnlDockBin.draw");
+
+  return ret;
 }
 
 static void
@@ -868,7 +1073,7 @@ pnl_dock_bin_set_child_priority (PnlDockBin *self,
                      (GCompareDataFunc)pnl_dock_bin_child_compare,
                      NULL);
 
-  gtk_widget_queue_resize (GTK_WIDGET (self));
+  pnl_dock_bin_queue_resize (self);
 }
 
 static void
@@ -1005,6 +1210,73 @@ pnl_dock_bin_unmap (GtkWidget *widget)
   GTK_WIDGET_CLASS (pnl_dock_bin_parent_class)->unmap (widget);
 }
 
+static void
+pnl_dock_bin_apply_drag (PnlDockBin *self)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+  g_assert (priv->drag_child != NULL);
+
+  priv->drag_n_frames++;
+
+  /*
+   * Dragging a handle never changes what we request from our parent, so
+   * rather than changing the position of the edge (which would queue a
+   * resize all the way up to the toplevel) we only adjust the drag offset
+   * used when allocating our children. The edge is given its final
+   * position when the drag ends.
+   */
+  priv->drag_child->drag_offset =
+    priv->drag_pending_position - priv->drag_child->drag_begin_position;
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+}
+
+static gboolean
+pnl_dock_bin_drag_tick_cb (GtkWidget     *widget,
+                           GdkFrameClock *frame_clock,
+                           gpointer       user_data)
+{
+  PnlDockBin *self = (PnlDockBin *)widget;
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+  g_assert (GDK_IS_FRAME_CLOCK (frame_clock));
+
+  priv->drag_tick_handler = 0;
+
+  if (priv->drag_child != NULL)
+    pnl_dock_bin_apply_drag (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Applies any pan position that is still waiting for the next frame.
+ * Returns %TRUE if there was one.
+ */
+static gboolean
+pnl_dock_bin_flush_drag (PnlDockBin *self)
+{
+  PnlDockBinPrivate *priv = pnl_dock_bin_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_BIN (self));
+
+  if (priv->drag_tick_handler == 0)
+    return FALSE;
+
+  gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_handler);
+  priv->drag_tick_handler = 0;
+
+  if (priv->drag_child == NULL)
+    return FALSE;
+
+  pnl_dock_bin_apply_drag (self);
+
+  return TRUE;
+}
+
 static void
 pnl_dock_bin_pan_gesture_drag_begin (PnlDockBin    *self,
                                      gdouble        x,
@@ -1043,6 +1315,10 @@ pnl_dock_bin_pan_gesture_drag_begin (PnlDockBin    *self,
 
   priv->drag_child = child;
   priv->drag_child->drag_offset = 0;
+  priv->drag_n_events = 0;
+  priv->drag_n_frames = 0;
+
+  pnl_dock_bin_edge_set_dragging (PNL_DOCK_BIN_EDGE (child->widget), TRUE);
 
   if (child->type == PNL_DOCK_BIN_CHILD_LEFT || child->type == PNL_DOCK_BIN_CHILD_RIGHT)
     {
@@ -1077,24 +1353,52 @@ pnl_dock_bin_pan_gesture_drag_end (PnlDockBin    *self,
   state = gtk_gesture_get_sequence_state (GTK_GESTURE (gesture), sequence);
 
   if (state == GTK_EVENT_SEQUENCE_DENIED)
-    goto cleanup;
+    {
+      if (priv->drag_tick_handler != 0)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_handler);
+          priv->drag_tick_handler = 0;
+        }
+      goto cleanup;
+    }
 
   g_assert (priv->drag_child != NULL);
   g_assert (PNL_IS_DOCK_BIN_EDGE (priv->drag_child->widget));
 
-  gtk_widget_get_allocation (priv->drag_child->widget, &child_alloc);
-
-  if ((priv->drag_child->type == PNL_DOCK_BIN_CHILD_LEFT) ||
-      (priv->drag_child->type == PNL_DOCK_BIN_CHILD_RIGHT))
-    position = child_alloc.width;
+  /*
+   * If the final pan position was still waiting for a frame, the
+   * allocation has not caught up with it yet, so use it directly.
+   */
+  if (pnl_dock_bin_flush_drag (self))
+    {
+      position = priv->drag_pending_position;
+    }
   else
-    position = child_alloc.height;
+    {
+      gtk_widget_get_allocation (priv->drag_child->widget, &child_alloc);
+
+      if ((priv->drag_child->type == PNL_DOCK_BIN_CHILD_LEFT) ||
+          (priv->drag_child->type == PNL_DOCK_BIN_CHILD_RIGHT))
+        position = child_alloc.width;
+      else
+        position = child_alloc.height;
+    }
+
+  if (debug_drag)
+    g_printerr ("%s: %u pan events in %u frames, %u coalesced\n",
+                G_OBJECT_TYPE_NAME (self),
+                priv->drag_n_events,
+                priv->drag_n_frames,
+                priv->drag_n_events - MIN (priv->drag_n_events, priv->drag_n_frames));
 
   pnl_dock_bin_edge_set_position (PNL_DOCK_BIN_EDGE (priv->drag_child->widget), position);
 
+  pnl_dock_queue_autosave (GTK_WIDGET (self));
+
 cleanup:
   if (priv->drag_child != NULL)
     {
+      pnl_dock_bin_edge_set_dragging (PNL_DOCK_BIN_EDGE (priv->drag_child->widget), FALSE);
       priv->drag_child->drag_offset = 0;
       priv->drag_child->drag_begin_position = 0;
       priv->drag_child = NULL;
@@ -1147,11 +1451,19 @@ pnl_dock_bin_pan_gesture_pan (PnlDockBin      *self,
         offset = -offset;
     }
 
-  priv->drag_child->drag_offset = (gint)offset;
+  position = priv->drag_child->drag_begin_position + (gint)offset;
 
-  position = priv->drag_child->drag_offset + priv->drag_child->drag_begin_position;
   if (position >= 0)
-    pnl_dock_bin_edge_set_position (PNL_DOCK_BIN_EDGE (priv->drag_child->widget), position);
+    {
+      priv->drag_pending_position = position;
+      priv->drag_n_events++;
+
+      if (priv->drag_tick_handler == 0)
+        priv->drag_tick_handler =
+          gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                        pnl_dock_bin_drag_tick_cb,
+                                        NULL, NULL);
+    }
 }
 
 static void
@@ -1226,7 +1538,7 @@ pnl_dock_bin_drag_motion (GtkWidget      *widget,
   priv->dnd_drag_x = x;
   priv->dnd_drag_y = y;
 
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  pnl_dock_bin_set_dnd_zone (self, pnl_dock_bin_get_dnd_zone (self, x, y));
 
   return TRUE;
 }
@@ -1242,6 +1554,8 @@ pnl_dock_bin_drag_leave (GtkWidget      *widget,
   g_assert (PNL_IS_DOCK_BIN (self));
   g_assert (GDK_IS_DRAG_CONTEXT (context));
 
+  pnl_dock_bin_set_dnd_zone (self, LAST_PNL_DOCK_BIN_CHILD);
+
   priv->dnd_drag_x = -1;
   priv->dnd_drag_y = -1;
 }
@@ -1381,9 +1695,12 @@ pnl_dock_bin_class_init (PnlDockBinClass *klass)
   object_class->get_property = pnl_dock_bin_get_property;
   object_class->set_property = pnl_dock_bin_set_property;
 
+  debug_drag = !!g_getenv ("PNL_DRAG_DEBUG");
+
   widget_class->destroy = pnl_dock_bin_destroy;
   widget_class->drag_leave = pnl_dock_bin_drag_leave;
   widget_class->drag_motion = pnl_dock_bin_drag_motion;
+  widget_class->draw = pnl_dock_bin_draw;
   widget_class->get_preferred_height = pnl_dock_bin_get_preferred_height;
   widget_class->get_preferred_width = pnl_dock_bin_get_preferred_width;
   widget_class->grab_focus = pnl_dock_bin_grab_focus;
@@ -1423,6 +1740,17 @@ pnl_dock_bin_class_init (PnlDockBinClass *klass)
   gtk_widget_class_set_css_name (widget_class, "dockbin");
 }
 
+static void
+pnl_dock_bin_edge_notify_reveal_child (PnlDockBin     *self,
+                                       GParamSpec     *pspec,
+                                       PnlDockBinEdge *edge)
+{
+  g_assert (PNL_IS_DOCK_BIN (self));
+  g_assert (PNL_IS_DOCK_BIN_EDGE (edge));
+
+  pnl_dock_queue_autosave (GTK_WIDGET (self));
+}
+
 static void
 pnl_dock_bin_init_child (PnlDockBin          *self,
                          PnlDockBinChild     *child,
@@ -1454,6 +1782,12 @@ pnl_dock_bin_init_child (PnlDockBin          *self,
                                G_BINDING_SYNC_CREATE,
                                map_boolean_to_variant,
                                NULL, NULL, NULL);
+
+  g_signal_connect_object (child->widget,
+                           "notify::reveal-child",
+                           G_CALLBACK (pnl_dock_bin_edge_notify_reveal_child),
+                           self,
+                           G_CONNECT_SWAPPED);
 }
 
 static void
@@ -1492,6 +1826,7 @@ pnl_dock_bin_init (PnlDockBin *self)
                      G_N_ELEMENTS (drag_entries),
                      GDK_ACTION_MOVE);
 
+  priv->dnd_zone = LAST_PNL_DOCK_BIN_CHILD;
   priv->dnd_drag_x = -1;
   priv->dnd_drag_y = -1;
 
@@ -17,7 +17,9 @@
  */
 
 #include "pnl-dock-item.h"
+#include "pnl-dock-item-private.h"
 #include "pnl-dock-manager.h"
+#include "pnl-dock-manager-private.h"
 #include "pnl-dock-widget.h"
 
 G_DEFINE_INTERFACE (PnlDockItem, pnl_dock_item, GTK_TYPE_WIDGET)
@@ -28,75 +30,399 @@ G_DEFINE_INTERFACE (PnlDockItem, pnl_dock_item, GTK_TYPE_WIDGET)
  * without having to duplicate all sorts of plumbing.
  */
 
+/*
+ * Each dock item keeps a link to its dock parent (the nearest dock item
+ * above it in the widget tree) and to its dock children. This lets us
+ * walk the dock tree without visiting all of the plain widgets that sit
+ * in between, such as the GtkStack inside a PnlDockStack or the
+ * revealers of a PnlDockBin. The links are created when an item is
+ * adopted, or the first time its dock parent is requested, and are
+ * updated whenever the item is moved to another widget parent.
+ */
+typedef struct
+{
+  PnlDockManager *manager;
+  PnlDockItem    *parent;
+  GPtrArray      *children;
+
+  /* A stable identifier, indexed by the manager. */
+  gchar          *id;
+
+  /*
+   * The number of children that contain a PnlDockWidget, plus one if we
+   * are a PnlDockWidget ourselves. Our parent only needs to hear about
+   * it when this goes from or to zero, see pnl_dock_item_add_widgets().
+   */
+  guint           n_widgets;
+
+  /*
+   * Visibility updates are coalesced and run once per frame, before
+   * layout, from this tick callback. See
+   * pnl_dock_item_queue_update_visibility().
+   */
+  guint           visibility_tick;
+} PnlDockItemLinks;
+
 enum {
   MANAGER_SET,
   N_SIGNALS
 };
 
 static guint signals [N_SIGNALS];
+static GQuark links_quark;
+
+static void         pnl_dock_item_child_weak_notify      (gpointer     data,
+                                                          GObject     *where_object_was);
+static void         pnl_dock_item_notify_parent          (PnlDockItem *self,
+                                                          GParamSpec  *pspec,
+                                                          gpointer     user_data);
+static void         pnl_dock_item_real_update_visibility (PnlDockItem *self);
+static PnlDockItem *pnl_dock_item_find_ancestor          (PnlDockItem *self);
+
+static PnlDockItemLinks *
+pnl_dock_item_peek_links (PnlDockItem *self)
+{
+  return g_object_get_qdata (G_OBJECT (self), links_quark);
+}
+
+static gboolean
+pnl_dock_item_links_have_widgets (PnlDockItemLinks *links)
+{
+  return links != NULL && links->n_widgets > 0;
+}
+
+static void
+pnl_dock_item_add_widgets (PnlDockItem *self,
+                           gint         delta)
+{
+  /*
+   * Walk up while the change flips whether an item has widgets. Once an
+   * item already had (or still has) widgets, nothing above it changes.
+   */
+  while (self != NULL)
+    {
+      PnlDockItemLinks *links = pnl_dock_item_peek_links (self);
+      gboolean had_widgets;
+
+      g_assert (links != NULL);
+      g_assert (delta > 0 || links->n_widgets > 0);
+
+      had_widgets = links->n_widgets > 0;
+      links->n_widgets += delta;
+
+      if (had_widgets == (links->n_widgets > 0))
+        break;
+
+      self = links->parent;
+    }
+}
+
+static void
+pnl_dock_item_unlink_children (PnlDockItem      *self,
+                               PnlDockItemLinks *links)
+{
+  g_assert (PNL_IS_DOCK_ITEM (self));
+  g_assert (links != NULL);
+
+  while (links->children->len > 0)
+    {
+      PnlDockItem *child = g_ptr_array_index (links->children, links->children->len - 1);
+      PnlDockItemLinks *child_links = pnl_dock_item_peek_links (child);
+
+      g_ptr_array_remove_index (links->children, links->children->len - 1);
+      g_object_weak_unref (G_OBJECT (child), pnl_dock_item_child_weak_notify, self);
+
+      if (pnl_dock_item_links_have_widgets (child_links))
+        pnl_dock_item_add_widgets (self, -1);
+
+      if (child_links != NULL && child_links->parent == self)
+        child_links->parent = NULL;
+    }
+}
+
+static void
+pnl_dock_item_links_free (gpointer data)
+{
+  PnlDockItemLinks *links = data;
+
+  /*
+   * We are only freed when the item is finalized, so our parent has
+   * already been told through its weak reference, and our children
+   * were unlinked when we were destroyed.
+   */
+  g_assert (links->children->len == 0);
+
+  g_clear_object (&links->manager);
+  g_clear_pointer (&links->children, g_ptr_array_unref);
+  g_clear_pointer (&links->id, g_free);
+  g_slice_free (PnlDockItemLinks, links);
+}
+
+static void
+pnl_dock_item_destroy (PnlDockItem *self)
+{
+  PnlDockItemLinks *links;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  if (NULL != (links = pnl_dock_item_peek_links (self)))
+    {
+      if (links->visibility_tick != 0)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (self), links->visibility_tick);
+          links->visibility_tick = 0;
+        }
+
+      pnl_dock_item_unlink_children (self, links);
+    }
+}
+
+static PnlDockItemLinks *
+pnl_dock_item_get_links (PnlDockItem *self)
+{
+  PnlDockItemLinks *links;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  if (NULL == (links = pnl_dock_item_peek_links (self)))
+    {
+      links = g_slice_new0 (PnlDockItemLinks);
+      links->children = g_ptr_array_new ();
+      links->n_widgets = PNL_IS_DOCK_WIDGET (self) ? 1 : 0;
+      g_object_set_qdata_full (G_OBJECT (self), links_quark, links, pnl_dock_item_links_free);
+      g_signal_connect (self,
+                        "destroy",
+                        G_CALLBACK (pnl_dock_item_destroy),
+                        NULL);
+      g_signal_connect (self,
+                        "notify::parent",
+                        G_CALLBACK (pnl_dock_item_notify_parent),
+                        NULL);
+    }
+
+  return links;
+}
+
+static void
+pnl_dock_item_child_weak_notify (gpointer  data,
+                                 GObject  *where_object_was)
+{
+  PnlDockItem *self = data;
+  PnlDockItemLinks *links;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  /*
+   * The item is being disposed, but its links are only released when it
+   * is finalized so we can still tell if it counted towards ours.
+   */
+  if (NULL != (links = pnl_dock_item_peek_links (self)) &&
+      g_ptr_array_remove (links->children, where_object_was) &&
+      pnl_dock_item_links_have_widgets (pnl_dock_item_peek_links ((PnlDockItem *)where_object_was)))
+    pnl_dock_item_add_widgets (self, -1);
+
+  pnl_dock_item_queue_update_visibility (self);
+}
+
+static void
+pnl_dock_item_unlink (PnlDockItem *self)
+{
+  PnlDockItemLinks *links;
+  PnlDockItemLinks *parent_links;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  links = pnl_dock_item_get_links (self);
+
+  if (links->parent == NULL)
+    return;
+
+  parent_links = pnl_dock_item_get_links (links->parent);
+  g_ptr_array_remove (parent_links->children, self);
+  g_object_weak_unref (G_OBJECT (self), pnl_dock_item_child_weak_notify, links->parent);
+
+  if (links->n_widgets > 0)
+    pnl_dock_item_add_widgets (links->parent, -1);
+
+  links->parent = NULL;
+}
+
+static void
+pnl_dock_item_link (PnlDockItem *self,
+                    PnlDockItem *parent)
+{
+  PnlDockItemLinks *links;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+  g_assert (PNL_IS_DOCK_ITEM (parent));
+  g_assert (self != parent);
+
+  links = pnl_dock_item_get_links (self);
+
+  if (links->parent == parent)
+    return;
+
+  pnl_dock_item_unlink (self);
+
+  links->parent = parent;
+  g_ptr_array_add (pnl_dock_item_get_links (parent)->children, self);
+  g_object_weak_ref (G_OBJECT (self), pnl_dock_item_child_weak_notify, parent);
+
+  if (links->n_widgets > 0)
+    pnl_dock_item_add_widgets (parent, 1);
+}
+
+static PnlDockItem *
+pnl_dock_item_find_ancestor (PnlDockItem *self)
+{
+  GtkWidget *parent;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  for (parent = gtk_widget_get_parent (GTK_WIDGET (self));
+       parent != NULL;
+       parent = gtk_widget_get_parent (parent))
+    {
+      if (PNL_IS_DOCK_ITEM (parent))
+        return PNL_DOCK_ITEM (parent);
+    }
+
+  return NULL;
+}
+
+/*
+ * The cached dock parent is only valid while we stay below it in the
+ * widget tree. When we are moved, relink to the nearest dock item above
+ * us, if any, so that presenting and visibility updates keep following
+ * the live widget tree.
+ */
+static void
+pnl_dock_item_notify_parent (PnlDockItem *self,
+                             GParamSpec  *pspec,
+                             gpointer     user_data)
+{
+  PnlDockItemLinks *links;
+  PnlDockItem *old_parent;
+  PnlDockItem *parent;
+
+  g_assert (PNL_IS_DOCK_ITEM (self));
+
+  links = pnl_dock_item_get_links (self);
+  old_parent = links->parent;
+
+  if (NULL != (parent = pnl_dock_item_find_ancestor (self)))
+    pnl_dock_item_link (self, parent);
+  else
+    pnl_dock_item_unlink (self);
+
+  if (old_parent != NULL && old_parent != links->parent)
+    pnl_dock_item_queue_update_visibility (old_parent);
+}
+
+/*
+ * pnl_dock_item_get_parent:
+ *
+ * Gets the nearest dock item containing @self. Items that were never
+ * adopted, such as the panes created by a PnlDockBin edge, are linked
+ * to their dock parent the first time this is called.
+ *
+ * Returns: (transfer none) (nullable): a #PnlDockItem or %NULL.
+ */
+PnlDockItem *
+pnl_dock_item_get_parent (PnlDockItem *self)
+{
+  PnlDockItemLinks *links;
+  PnlDockItem *parent;
+
+  g_return_val_if_fail (PNL_IS_DOCK_ITEM (self), NULL);
+
+  links = pnl_dock_item_get_links (self);
+
+  if (links->parent == NULL && NULL != (parent = pnl_dock_item_find_ancestor (self)))
+    pnl_dock_item_link (self, parent);
+
+  return links->parent;
+}
+
+/*
+ * pnl_dock_item_get_children:
+ *
+ * Returns: (transfer none) (element-type PnlDockItem): the dock items
+ *   linked below @self.
+ */
+GPtrArray *
+pnl_dock_item_get_children (PnlDockItem *self)
+{
+  g_return_val_if_fail (PNL_IS_DOCK_ITEM (self), NULL);
+
+  return pnl_dock_item_get_links (self)->children;
+}
 
 static void
 pnl_dock_item_real_set_manager (PnlDockItem    *self,
                                 PnlDockManager *manager)
 {
+  PnlDockItemLinks *links;
   PnlDockManager *old_manager;
 
   g_assert (PNL_IS_DOCK_ITEM (self));
   g_assert (!manager || PNL_IS_DOCK_MANAGER (manager));
 
-  if (NULL != (old_manager = pnl_dock_item_get_manager (self)))
+  links = pnl_dock_item_get_links (self);
+
+  if (NULL != (old_manager = links->manager))
     {
       if (PNL_IS_DOCK (self))
         pnl_dock_manager_unregister_dock (old_manager, PNL_DOCK (self));
+
+      if (old_manager != manager)
+        pnl_dock_manager_remove_item (old_manager, self);
     }
 
+  /* Keep the old manager alive until the signal has been emitted. */
+  links->manager = manager ? g_object_ref (manager) : NULL;
+
   if (manager != NULL)
     {
-      g_object_set_data_full (G_OBJECT (self),
-                              "PNL_DOCK_MANAGER",
-                              g_object_ref (manager),
-                              g_object_unref);
+      pnl_dock_manager_add_item (manager, self);
+
       if (PNL_IS_DOCK (self))
         pnl_dock_manager_register_dock (manager, PNL_DOCK (self));
     }
-  else
-    g_object_set_data (G_OBJECT (self), "PNL_DOCK_MANAGER", NULL);
 
   g_signal_emit (self, signals [MANAGER_SET], 0, old_manager);
+
+  g_clear_object (&old_manager);
 }
 
 static PnlDockManager *
 pnl_dock_item_real_get_manager (PnlDockItem *self)
 {
+  PnlDockItemLinks *links;
+
   g_assert (PNL_IS_DOCK_ITEM (self));
 
-  return g_object_get_data (G_OBJECT (self), "PNL_DOCK_MANAGER");
+  links = pnl_dock_item_peek_links (self);
+
+  return links ? links->manager : NULL;
 }
 
 static void
 pnl_dock_item_real_update_visibility (PnlDockItem *self)
 {
-  GtkWidget *parent;
+  PnlDockItem *parent;
 
   g_assert (PNL_IS_DOCK_ITEM (self));
 
-  for (parent = gtk_widget_get_parent (GTK_WIDGET (self));
-       parent != NULL;
-       parent = gtk_widget_get_parent (parent))
-    {
-      if (PNL_IS_DOCK_ITEM (parent))
-        {
-          pnl_dock_item_update_visibility (PNL_DOCK_ITEM (parent));
-          break;
-        }
-    }
+  if (NULL != (parent = pnl_dock_item_get_parent (self)))
+    pnl_dock_item_update_visibility (parent);
 }
 
 static void
 pnl_dock_item_propagate_manager (PnlDockItem *self)
 {
   PnlDockManager *manager;
-  GPtrArray *ar;
+  PnlDockItemLinks *links;
   guint i;
 
   g_return_if_fail (PNL_IS_DOCK_ITEM (self));
@@ -107,12 +433,12 @@ pnl_dock_item_propagate_manager (PnlDockItem *self)
   if (NULL == (manager = pnl_dock_item_get_manager (self)))
     return;
 
-  if (NULL == (ar = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS")))
+  if (NULL == (links = pnl_dock_item_peek_links (self)))
     return;
 
-  for (i = 0; i < ar->len; i++)
+  for (i = 0; i < links->children->len; i++)
     {
-      PnlDockItem *item = g_ptr_array_index (ar, i);
+      PnlDockItem *item = g_ptr_array_index (links->children, i);
 
       pnl_dock_item_set_manager (item, manager);
     }
@@ -131,6 +457,8 @@ pnl_dock_item_real_manager_set (PnlDockItem    *self,
 static void
 pnl_dock_item_default_init (PnlDockItemInterface *iface)
 {
+  links_quark = g_quark_from_static_string ("PNL_DOCK_ITEM_LINKS");
+
   iface->get_manager = pnl_dock_item_real_get_manager;
   iface->set_manager = pnl_dock_item_real_set_manager;
   iface->manager_set = pnl_dock_item_real_manager_set;
@@ -178,6 +506,60 @@ pnl_dock_item_set_manager (PnlDockItem    *self,
   PNL_DOCK_ITEM_GET_IFACE (self)->set_manager (self, manager);
 }
 
+/**
+ * pnl_dock_item_get_id:
+ * @self: A #PnlDockItem
+ *
+ * Gets the identifier set with pnl_dock_item_set_id().
+ *
+ * Returns: (nullable): the identifier of @self, or %NULL.
+ */
+const gchar *
+pnl_dock_item_get_id (PnlDockItem *self)
+{
+  PnlDockItemLinks *links;
+
+  g_return_val_if_fail (PNL_IS_DOCK_ITEM (self), NULL);
+
+  links = pnl_dock_item_peek_links (self);
+
+  return links ? links->id : NULL;
+}
+
+/**
+ * pnl_dock_item_set_id:
+ * @self: A #PnlDockItem
+ * @id: (nullable): a stable identifier, or %NULL
+ *
+ * Sets an identifier for @self that is stable across sessions, such as
+ * the name of the tool it contains. The dock manager indexes items by
+ * identifier so they can be found with pnl_dock_manager_lookup_item().
+ * Identifiers should be unique within a manager. If they are not, a
+ * warning is emitted and the item registered first is the one found.
+ */
+void
+pnl_dock_item_set_id (PnlDockItem *self,
+                      const gchar *id)
+{
+  PnlDockItemLinks *links;
+  gchar *old_id;
+
+  g_return_if_fail (PNL_IS_DOCK_ITEM (self));
+
+  links = pnl_dock_item_get_links (self);
+
+  if (g_strcmp0 (id, links->id) == 0)
+    return;
+
+  old_id = links->id;
+  links->id = g_strdup (id);
+
+  if (links->manager != NULL)
+    pnl_dock_manager_item_id_changed (links->manager, self, old_id);
+
+  g_free (old_id);
+}
+
 void
 pnl_dock_item_update_visibility (PnlDockItem *self)
 {
@@ -186,77 +568,83 @@ pnl_dock_item_update_visibility (PnlDockItem *self)
   PNL_DOCK_ITEM_GET_IFACE (self)->update_visibility (self);
 }
 
-static void
-pnl_dock_item_child_weak_notify (gpointer  data,
-                                 GObject  *where_object_was)
+static gboolean
+pnl_dock_item_visibility_tick_cb (GtkWidget     *widget,
+                                  GdkFrameClock *frame_clock,
+                                  gpointer       user_data)
 {
-  PnlDockItem *self = data;
-  GPtrArray *descendants;
+  PnlDockItem *self = (PnlDockItem *)widget;
+  PnlDockItemLinks *links;
 
   g_assert (PNL_IS_DOCK_ITEM (self));
 
-  descendants = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS");
-
-  if (descendants != NULL)
-    g_ptr_array_remove (descendants, where_object_was);
+  links = pnl_dock_item_get_links (self);
+  links->visibility_tick = 0;
 
   pnl_dock_item_update_visibility (self);
+
+  return G_SOURCE_REMOVE;
 }
 
-static void
-pnl_dock_item_destroy (PnlDockItem *self)
+/*
+ * pnl_dock_item_queue_update_visibility:
+ *
+ * Like pnl_dock_item_update_visibility(), but deferred until the next
+ * frame. The default implementation only forwards to the dock parent,
+ * so we go straight to the nearest item that implements it and queue
+ * the update there. Any number of changes below that item before the
+ * next frame result in a single update.
+ */
+void
+pnl_dock_item_queue_update_visibility (PnlDockItem *self)
 {
-  GPtrArray *descendants;
-  guint i;
-
-  g_assert (PNL_IS_DOCK_ITEM (self));
+  PnlDockItemLinks *links;
 
-  descendants = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS");
+  g_return_if_fail (PNL_IS_DOCK_ITEM (self));
 
-  if (descendants != NULL)
+  while (PNL_DOCK_ITEM_GET_IFACE (self)->update_visibility == pnl_dock_item_real_update_visibility)
     {
-      for (i = 0; i < descendants->len; i++)
-        {
-          PnlDockItem *child = g_ptr_array_index (descendants, i);
+      if (NULL == (self = pnl_dock_item_get_parent (self)))
+        return;
+    }
 
-          g_object_weak_unref (G_OBJECT (child),
-                               pnl_dock_item_child_weak_notify,
-                               self);
-        }
+  links = pnl_dock_item_get_links (self);
 
-      g_object_set_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS", NULL);
-      g_ptr_array_unref (descendants);
-    }
+  if (links->manager != NULL &&
+      pnl_dock_manager_defer_update_visibility (links->manager, self))
+    return;
+
+  if (links->visibility_tick == 0)
+    links->visibility_tick =
+      gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                    pnl_dock_item_visibility_tick_cb,
+                                    NULL,
+                                    NULL);
 }
 
 static void
 pnl_dock_item_track_child (PnlDockItem *self,
                            PnlDockItem *child)
 {
-  GPtrArray *descendants;
+  PnlDockItem *parent;
 
   g_assert (PNL_IS_DOCK_ITEM (self));
   g_assert (PNL_IS_DOCK_ITEM (child));
 
-  descendants = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS");
+  /*
+   * Containers may adopt an item on behalf of one of their own
+   * descendants (a PnlDockOverlay adopts what it adds to its edges), or
+   * before it has been added anywhere (a PnlDockBin adopts before
+   * adding to an edge). Always link to the nearest dock item that holds
+   * the child, and make sure that one is linked up the tree as well.
+   */
+  if (NULL == (parent = pnl_dock_item_find_ancestor (child)))
+    parent = self;
 
-  if (descendants == NULL)
-    {
-      descendants = g_ptr_array_new ();
-      g_object_set_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS", descendants);
-      g_signal_connect (self,
-                        "destroy",
-                        G_CALLBACK (pnl_dock_item_destroy),
-                        NULL);
-    }
-
-  g_object_weak_ref (G_OBJECT (child),
-                     pnl_dock_item_child_weak_notify,
-                     self);
-
-  g_ptr_array_add (descendants, child);
+  pnl_dock_item_link (child, parent);
+  pnl_dock_item_get_parent (parent);
 
-  pnl_dock_item_update_visibility (child);
+  pnl_dock_item_queue_update_visibility (child);
 }
 
 gboolean
@@ -304,55 +692,32 @@ pnl_dock_item_present_child (PnlDockItem *self,
  * pnl_dock_item_present:
  * @self: A #PnlDockItem
  *
- * This widget will walk the widget hierarchy to ensure that the
+ * This widget will walk the dock hierarchy to ensure that the
  * dock item is visible to the user.
  */
 void
 pnl_dock_item_present (PnlDockItem *self)
 {
-  GtkWidget *parent;
+  PnlDockItem *parent;
 
   g_return_if_fail (PNL_IS_DOCK_ITEM (self));
 
-  for (parent = gtk_widget_get_parent (GTK_WIDGET (self));
-       parent != NULL;
-       parent = gtk_widget_get_parent (parent))
+  if (NULL != (parent = pnl_dock_item_get_parent (self)))
     {
-      if (PNL_IS_DOCK_ITEM (parent))
-        {
-          pnl_dock_item_present_child (PNL_DOCK_ITEM (parent), self);
-          pnl_dock_item_present (PNL_DOCK_ITEM (parent));
-          return;
-        }
+      pnl_dock_item_present_child (parent, self);
+      pnl_dock_item_present (parent);
     }
 }
 
 gboolean
 pnl_dock_item_has_widgets (PnlDockItem *self)
 {
-  GPtrArray *ar;
-
   g_return_val_if_fail (PNL_IS_DOCK_ITEM (self), FALSE);
 
   if (PNL_IS_DOCK_WIDGET (self))
     return TRUE;
 
-  ar = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS");
-
-  if (ar != NULL)
-    {
-      guint i;
-
-      for (i = 0; i < ar->len; i++)
-        {
-          PnlDockItem *child = g_ptr_array_index (ar, i);
-
-          if (pnl_dock_item_has_widgets (child))
-            return TRUE;
-        }
-    }
-
-  return FALSE;
+  return pnl_dock_item_links_have_widgets (pnl_dock_item_peek_links (self));
 }
 
 static void
@@ -360,13 +725,12 @@ pnl_dock_item_printf_internal (PnlDockItem *self,
                                GString     *str,
                                guint        depth)
 {
-  GPtrArray *ar;
+  PnlDockItemLinks *links;
   guint i;
 
   g_assert (PNL_IS_DOCK_ITEM (self));
   g_assert (str != NULL);
 
-
   for (i = 0; i < depth; i++)
     g_string_append_c (str, ' ');
 
@@ -374,12 +738,12 @@ pnl_dock_item_printf_internal (PnlDockItem *self,
 
   ++depth;
 
-  ar = g_object_get_data (G_OBJECT (self), "PNL_DOCK_ITEM_DESCENDANTS");
+  links = pnl_dock_item_peek_links (self);
 
-  if (ar != NULL)
+  if (links != NULL)
     {
-      for (i = 0; i < ar->len; i++)
-        pnl_dock_item_printf_internal (g_ptr_array_index (ar, i), str, depth);
+      for (i = 0; i < links->children->len; i++)
+        pnl_dock_item_printf_internal (g_ptr_array_index (links->children, i), str, depth);
     }
 }
 
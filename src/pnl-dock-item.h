@@ -47,6 +47,9 @@ void            pnl_dock_item_present_child     (PnlDockItem    *self,
                                                  PnlDockItem    *child);
 void            pnl_dock_item_update_visibility (PnlDockItem    *self);
 gboolean        pnl_dock_item_has_widgets       (PnlDockItem    *self);
+const gchar    *pnl_dock_item_get_id            (PnlDockItem    *self);
+void            pnl_dock_item_set_id            (PnlDockItem    *self,
+                                                 const gchar    *id);
 void            _pnl_dock_item_printf           (PnlDockItem    *self);
 
 G_END_DECLS
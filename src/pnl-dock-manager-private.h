@@ -0,0 +1,42 @@
+/* pnl-dock-manager-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PNL_DOCK_MANAGER_PRIVATE_H
+#define PNL_DOCK_MANAGER_PRIVATE_H
+
+#include "pnl-dock-manager.h"
+
+G_BEGIN_DECLS
+
+void     pnl_dock_manager_add_item                (PnlDockManager *self,
+                                                   PnlDockItem    *item);
+void     pnl_dock_manager_remove_item             (PnlDockManager *self,
+                                                   PnlDockItem    *item);
+void     pnl_dock_manager_item_id_changed         (PnlDockManager *self,
+                                                   PnlDockItem    *item,
+                                                   const gchar    *old_id);
+gboolean pnl_dock_manager_defer_update_visibility (PnlDockManager *self,
+                                                   PnlDockItem    *item);
+void     pnl_dock_manager_widget_hidden           (PnlDockManager *self,
+                                                   PnlDockWidget  *widget);
+void     pnl_dock_manager_widget_shown            (PnlDockManager *self,
+                                                   PnlDockWidget  *widget);
+
+G_END_DECLS
+
+#endif /* PNL_DOCK_MANAGER_PRIVATE_H */
@@ -16,23 +16,298 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "pnl-dock-manager.h"
+#include "pnl-dock-item.h"
+#include "pnl-dock-manager-private.h"
+#include "pnl-multi-paned.h"
+#include "pnl-dock-widget-private.h"
+
+/*
+ * The queue link is embedded so that an entry can be unlinked in O(1)
+ * from the widget, which keeps a pointer to its entry while hidden.
+ */
+typedef struct
+{
+  GList           link;
+  PnlDockManager *manager;
+  PnlDockWidget  *widget;
+  gint64          hidden_at;
+  guint64         cost;
+} PnlDockManagerHidden;
 
 typedef struct
 {
-  GPtrArray *docks;
+  /*
+   * Registered docks and dock items. The arrays keep the order used for
+   * iteration, the hash tables map each member to its index in the array
+   * so that removal is O(1) (the last member is moved into the hole).
+   */
+  GPtrArray  *docks;
+  GHashTable *dock_index;
+  GPtrArray  *items;
+  GHashTable *item_index;
+
+  /*
+   * Items by their "id". Ids are expected to be unique, the first item
+   * registered with an id keeps it. has_duplicate_ids is set once another
+   * item was refused, so that the id can be handed over to it later.
+   */
+  GHashTable *items_by_id;
+  guint       has_duplicate_ids : 1;
+
+  /*
+   * While a transaction is open, every item is held here with its layout
+   * and child notifications frozen, and visibility updates are collected
+   * in pending_visibility to be run once when it is committed.
+   */
+  GPtrArray  *transaction_items;
+  GHashTable *pending_visibility;
+  guint       transaction_depth;
+
+  /*
+   * Dock widgets that are currently hidden, most recently hidden first.
+   * The oldest entries are hibernated once they have been hidden for
+   * longer than hibernate_delay seconds, or while the estimated cost of
+   * all hidden widgets exceeds hibernate_budget bytes.
+   */
+  GQueue     hidden;
+  guint64    hidden_cost;
+  guint64    hibernate_budget;
+  guint      hibernate_delay;
+  guint      hibernate_source;
 } PnlDockManagerPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PnlDockManager, pnl_dock_manager, G_TYPE_OBJECT)
 
 enum {
+  PROP_0,
+  PROP_HIBERNATE_BUDGET,
+  PROP_HIBERNATE_DELAY,
+  N_PROPS
+};
+
+enum {
+  ITEM_ADDED,
+  ITEM_REMOVED,
   REGISTER_DOCK,
   UNREGISTER_DOCK,
   N_SIGNALS
 };
 
+static GParamSpec *properties [N_PROPS];
 static guint signals [N_SIGNALS];
 
+static void pnl_dock_manager_queue_hibernate (PnlDockManager *self,
+                                              guint           delay);
+
+static void
+pnl_dock_manager_hidden_weak_notify (gpointer  data,
+                                     GObject  *where_the_object_was)
+{
+  PnlDockManagerHidden *hidden = data;
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (hidden->manager);
+
+  g_assert (PNL_IS_DOCK_MANAGER (hidden->manager));
+  g_assert ((GObject *)hidden->widget == where_the_object_was);
+
+  priv->hidden_cost -= hidden->cost;
+  g_queue_unlink (&priv->hidden, &hidden->link);
+  g_slice_free (PnlDockManagerHidden, hidden);
+}
+
+static void
+pnl_dock_manager_hidden_free (PnlDockManager       *self,
+                              PnlDockManagerHidden *hidden)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+  g_assert (hidden != NULL);
+
+  priv->hidden_cost -= hidden->cost;
+  if (pnl_dock_widget_get_hidden_entry (hidden->widget) == hidden)
+    pnl_dock_widget_set_hidden_entry (hidden->widget, NULL);
+  g_object_weak_unref (G_OBJECT (hidden->widget),
+                       pnl_dock_manager_hidden_weak_notify,
+                       hidden);
+  g_slice_free (PnlDockManagerHidden, hidden);
+}
+
+static gboolean
+pnl_dock_manager_hibernate_cb (gpointer user_data)
+{
+  PnlDockManager *self = user_data;
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  gint64 now;
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+
+  priv->hibernate_source = 0;
+
+  now = g_get_monotonic_time ();
+
+  while (priv->hidden.tail != NULL)
+    {
+      PnlDockManagerHidden *hidden = priv->hidden.tail->data;
+      gboolean over_budget;
+      gboolean expired;
+
+      over_budget = priv->hibernate_budget > 0 && priv->hidden_cost > priv->hibernate_budget;
+      expired = priv->hibernate_delay > 0 &&
+                (now - hidden->hidden_at) >= (gint64)priv->hibernate_delay * G_USEC_PER_SEC;
+
+      if (!over_budget && !expired)
+        break;
+
+      g_queue_pop_tail_link (&priv->hidden);
+      pnl_dock_widget_hibernate (hidden->widget);
+      pnl_dock_manager_hidden_free (self, hidden);
+    }
+
+  /* Wake up again when the oldest remaining widget expires. */
+  if (priv->hidden.tail != NULL && priv->hibernate_delay > 0)
+    {
+      PnlDockManagerHidden *hidden = priv->hidden.tail->data;
+      gint64 remaining;
+
+      remaining = hidden->hidden_at + (gint64)priv->hibernate_delay * G_USEC_PER_SEC - now;
+      pnl_dock_manager_queue_hibernate (self, MAX (1, remaining / G_USEC_PER_SEC));
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+pnl_dock_manager_queue_hibernate (PnlDockManager *self,
+                                  guint           delay)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+
+  if (priv->hibernate_source != 0)
+    g_source_remove (priv->hibernate_source);
+
+  /*
+   * Never hibernate from within the unmap that queued us, the widget
+   * tree may be in the middle of being hidden.
+   */
+  if (delay == 0)
+    priv->hibernate_source = g_idle_add_full (G_PRIORITY_LOW,
+                                              pnl_dock_manager_hibernate_cb,
+                                              self,
+                                              NULL);
+  else
+    priv->hibernate_source = g_timeout_add_seconds (delay,
+                                                    pnl_dock_manager_hibernate_cb,
+                                                    self);
+}
+
+void
+pnl_dock_manager_widget_hidden (PnlDockManager *self,
+                                PnlDockWidget  *widget)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  PnlDockManagerHidden *hidden;
+  GtkAllocation alloc;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (PNL_IS_DOCK_WIDGET (widget));
+
+  if (priv->hibernate_delay == 0 && priv->hibernate_budget == 0)
+    return;
+
+  /* Already tracked, keep the original time. */
+  pnl_dock_manager_widget_shown (self, widget);
+
+  /*
+   * We cannot know what the widget tree really holds on to, so estimate
+   * the cost as one ARGB32 surface of the last allocation.
+   */
+  gtk_widget_get_allocation (GTK_WIDGET (widget), &alloc);
+
+  hidden = g_slice_new0 (PnlDockManagerHidden);
+  hidden->link.data = hidden;
+  hidden->manager = self;
+  hidden->widget = widget;
+  hidden->hidden_at = g_get_monotonic_time ();
+  hidden->cost = (guint64)MAX (alloc.width, 1) * (guint64)MAX (alloc.height, 1) * 4;
+
+  g_object_weak_ref (G_OBJECT (widget), pnl_dock_manager_hidden_weak_notify, hidden);
+  g_queue_push_head_link (&priv->hidden, &hidden->link);
+  priv->hidden_cost += hidden->cost;
+  pnl_dock_widget_set_hidden_entry (widget, hidden);
+
+  if (priv->hibernate_budget > 0 && priv->hidden_cost > priv->hibernate_budget)
+    pnl_dock_manager_queue_hibernate (self, 0);
+  else if (priv->hibernate_source == 0)
+    pnl_dock_manager_queue_hibernate (self, priv->hibernate_delay);
+}
+
+void
+pnl_dock_manager_widget_shown (PnlDockManager *self,
+                               PnlDockWidget  *widget)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  PnlDockManagerHidden *hidden;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (PNL_IS_DOCK_WIDGET (widget));
+
+  hidden = pnl_dock_widget_get_hidden_entry (widget);
+
+  /* The widget may have been hidden while it belonged to another manager. */
+  if (hidden == NULL || hidden->manager != self)
+    return;
+
+  g_queue_unlink (&priv->hidden, &hidden->link);
+  pnl_dock_manager_hidden_free (self, hidden);
+}
+
+static gboolean
+pnl_dock_manager_index_add (GPtrArray  *ar,
+                            GHashTable *index,
+                            gpointer    member)
+{
+  g_assert (ar != NULL);
+  g_assert (index != NULL);
+
+  if (g_hash_table_contains (index, member))
+    return FALSE;
+
+  g_hash_table_insert (index, member, GUINT_TO_POINTER (ar->len));
+  g_ptr_array_add (ar, member);
+
+  return TRUE;
+}
+
+static gboolean
+pnl_dock_manager_index_remove (GPtrArray  *ar,
+                               GHashTable *index,
+                               gpointer    member)
+{
+  gpointer value;
+  guint pos;
+
+  g_assert (ar != NULL);
+  g_assert (index != NULL);
+
+  if (!g_hash_table_lookup_extended (index, member, NULL, &value))
+    return FALSE;
+
+  pos = GPOINTER_TO_UINT (value);
+
+  g_assert (pos < ar->len);
+  g_assert (g_ptr_array_index (ar, pos) == member);
+
+  g_hash_table_remove (index, member);
+  g_ptr_array_remove_index_fast (ar, pos);
+
+  if (pos < ar->len)
+    g_hash_table_insert (index, g_ptr_array_index (ar, pos), GUINT_TO_POINTER (pos));
+
+  return TRUE;
+}
+
 static void
 pnl_dock_manager_weak_notify (gpointer  data,
                               GObject  *where_the_object_was)
@@ -42,7 +317,7 @@ pnl_dock_manager_weak_notify (gpointer  data,
 
   g_assert (PNL_IS_DOCK_MANAGER (self));
 
-  g_ptr_array_remove (priv->docks, where_the_object_was);
+  pnl_dock_manager_index_remove (priv->docks, priv->dock_index, where_the_object_was);
 }
 
 static void
@@ -54,8 +329,8 @@ pnl_dock_manager_real_register_dock (PnlDockManager *self,
   g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
   g_return_if_fail (PNL_IS_DOCK (dock));
 
-  g_object_weak_ref (G_OBJECT (dock), pnl_dock_manager_weak_notify, self);
-  g_ptr_array_add (priv->docks, dock);
+  if (pnl_dock_manager_index_add (priv->docks, priv->dock_index, dock))
+    g_object_weak_ref (G_OBJECT (dock), pnl_dock_manager_weak_notify, self);
 }
 
 static void
@@ -63,24 +338,196 @@ pnl_dock_manager_real_unregister_dock (PnlDockManager *self,
                                        PnlDock        *dock)
 {
   PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
-  guint i;
 
   g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
   g_return_if_fail (PNL_IS_DOCK (dock));
 
-  for (i = 0; i < priv->docks->len; i++)
+  if (pnl_dock_manager_index_remove (priv->docks, priv->dock_index, dock))
+    g_object_weak_unref (G_OBJECT (dock), pnl_dock_manager_weak_notify, self);
+}
+
+static void
+pnl_dock_manager_suspend_item (PnlDockManager *self,
+                               PnlDockItem    *item)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+  g_assert (PNL_IS_DOCK_ITEM (item));
+  g_assert (priv->transaction_depth > 0);
+
+  g_ptr_array_add (priv->transaction_items, g_object_ref (item));
+
+  gtk_widget_freeze_child_notify (GTK_WIDGET (item));
+
+  if (PNL_IS_MULTI_PANED (item))
+    pnl_multi_paned_freeze_layout (PNL_MULTI_PANED (item));
+}
+
+static void
+pnl_dock_manager_index_item_id (PnlDockManager *self,
+                                PnlDockItem    *item,
+                                const gchar    *id)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  PnlDockItem *holder;
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+  g_assert (PNL_IS_DOCK_ITEM (item));
+  g_assert (id != NULL);
+
+  holder = g_hash_table_lookup (priv->items_by_id, id);
+
+  if (holder != NULL && holder != item)
     {
-      PnlDock *iter = g_ptr_array_index (priv->docks, i);
+      g_warning ("Dock item id \"%s\" is already used by a %s, ignoring it for a %s",
+                 id, G_OBJECT_TYPE_NAME (holder), G_OBJECT_TYPE_NAME (item));
+      priv->has_duplicate_ids = TRUE;
+      return;
+    }
+
+  g_hash_table_insert (priv->items_by_id, g_strdup (id), item);
+}
 
-      if (iter == dock)
+static void
+pnl_dock_manager_unindex_item_id (PnlDockManager *self,
+                                  PnlDockItem    *item,
+                                  const gchar    *id)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  guint i;
+
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+  g_assert (PNL_IS_DOCK_ITEM (item));
+  g_assert (id != NULL);
+
+  if (g_hash_table_lookup (priv->items_by_id, id) != (gpointer)item)
+    return;
+
+  g_hash_table_remove (priv->items_by_id, id);
+
+  if (!priv->has_duplicate_ids)
+    return;
+
+  /* Fall back to another item that was refused the same id. */
+  for (i = 0; i < priv->items->len; i++)
+    {
+      PnlDockItem *other = g_ptr_array_index (priv->items, i);
+
+      if (other != item && g_strcmp0 (pnl_dock_item_get_id (other), id) == 0)
         {
-          g_object_weak_unref (G_OBJECT (dock), pnl_dock_manager_weak_notify, self);
-          g_ptr_array_remove_index (priv->docks, i);
+          g_hash_table_insert (priv->items_by_id, g_strdup (id), other);
           break;
         }
     }
 }
 
+static void
+pnl_dock_manager_item_destroy (PnlDockItem    *item,
+                               PnlDockManager *self)
+{
+  g_assert (PNL_IS_DOCK_ITEM (item));
+  g_assert (PNL_IS_DOCK_MANAGER (self));
+
+  pnl_dock_manager_remove_item (self, item);
+}
+
+void
+pnl_dock_manager_add_item (PnlDockManager *self,
+                           PnlDockItem    *item)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  const gchar *id;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (PNL_IS_DOCK_ITEM (item));
+
+  /* Items are handed the manager again each time it is propagated. */
+  if (!pnl_dock_manager_index_add (priv->items, priv->item_index, item))
+    return;
+
+  if (NULL != (id = pnl_dock_item_get_id (item)))
+    pnl_dock_manager_index_item_id (self, item, id);
+
+  g_signal_connect (item,
+                    "destroy",
+                    G_CALLBACK (pnl_dock_manager_item_destroy),
+                    self);
+
+  if (priv->transaction_depth > 0)
+    pnl_dock_manager_suspend_item (self, item);
+
+  g_signal_emit (self, signals [ITEM_ADDED], 0, item);
+}
+
+void
+pnl_dock_manager_remove_item (PnlDockManager *self,
+                              PnlDockItem    *item)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  const gchar *id;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (PNL_IS_DOCK_ITEM (item));
+
+  if (!pnl_dock_manager_index_remove (priv->items, priv->item_index, item))
+    return;
+
+  if (NULL != (id = pnl_dock_item_get_id (item)))
+    pnl_dock_manager_unindex_item_id (self, item, id);
+
+  g_signal_handlers_disconnect_by_func (item,
+                                        G_CALLBACK (pnl_dock_manager_item_destroy),
+                                        self);
+
+  g_signal_emit (self, signals [ITEM_REMOVED], 0, item);
+}
+
+/*
+ * pnl_dock_manager_defer_update_visibility:
+ *
+ * Returns: %TRUE if a transaction is open, in which case @item will have
+ *   its visibility updated when the transaction is committed.
+ */
+gboolean
+pnl_dock_manager_defer_update_visibility (PnlDockManager *self,
+                                          PnlDockItem    *item)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), FALSE);
+  g_return_val_if_fail (PNL_IS_DOCK_ITEM (item), FALSE);
+
+  if (priv->transaction_depth == 0)
+    return FALSE;
+
+  if (!g_hash_table_contains (priv->pending_visibility, item))
+    g_hash_table_add (priv->pending_visibility, g_object_ref (item));
+
+  return TRUE;
+}
+
+void
+pnl_dock_manager_item_id_changed (PnlDockManager *self,
+                                  PnlDockItem    *item,
+                                  const gchar    *old_id)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  const gchar *id;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (PNL_IS_DOCK_ITEM (item));
+
+  if (!g_hash_table_contains (priv->item_index, item))
+    return;
+
+  if (old_id != NULL)
+    pnl_dock_manager_unindex_item_id (self, item, old_id);
+
+  if (NULL != (id = pnl_dock_item_get_id (item)))
+    pnl_dock_manager_index_item_id (self, item, id);
+}
+
 static void
 pnl_dock_manager_finalize (GObject *object)
 {
@@ -95,7 +542,26 @@ pnl_dock_manager_finalize (GObject *object)
       g_ptr_array_remove_index (priv->docks, priv->docks->len - 1);
     }
 
+  /* Items hold a reference to us, so there can be none left. */
+  g_assert (priv->items->len == 0);
+  g_assert (priv->transaction_depth == 0);
+
   g_clear_pointer (&priv->docks, g_ptr_array_unref);
+  g_clear_pointer (&priv->dock_index, g_hash_table_unref);
+  g_clear_pointer (&priv->items, g_ptr_array_unref);
+  g_clear_pointer (&priv->item_index, g_hash_table_unref);
+  g_clear_pointer (&priv->items_by_id, g_hash_table_unref);
+  g_clear_pointer (&priv->transaction_items, g_ptr_array_unref);
+  g_clear_pointer (&priv->pending_visibility, g_hash_table_unref);
+
+  while (priv->hidden.head != NULL)
+    pnl_dock_manager_hidden_free (self, g_queue_pop_head_link (&priv->hidden)->data);
+
+  if (priv->hibernate_source != 0)
+    {
+      g_source_remove (priv->hibernate_source);
+      priv->hibernate_source = 0;
+    }
 
   G_OBJECT_CLASS (pnl_dock_manager_parent_class)->finalize (object);
 }
@@ -106,8 +572,18 @@ pnl_dock_manager_get_property (GObject    *object,
                                GValue     *value,
                                GParamSpec *pspec)
 {
+  PnlDockManager *self = PNL_DOCK_MANAGER (object);
+
   switch (prop_id)
     {
+    case PROP_HIBERNATE_BUDGET:
+      g_value_set_uint64 (value, pnl_dock_manager_get_hibernate_budget (self));
+      break;
+
+    case PROP_HIBERNATE_DELAY:
+      g_value_set_uint (value, pnl_dock_manager_get_hibernate_delay (self));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -119,8 +595,18 @@ pnl_dock_manager_set_property (GObject      *object,
                                const GValue *value,
                                GParamSpec   *pspec)
 {
+  PnlDockManager *self = PNL_DOCK_MANAGER (object);
+
   switch (prop_id)
     {
+    case PROP_HIBERNATE_BUDGET:
+      pnl_dock_manager_set_hibernate_budget (self, g_value_get_uint64 (value));
+      break;
+
+    case PROP_HIBERNATE_DELAY:
+      pnl_dock_manager_set_hibernate_delay (self, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -138,6 +624,57 @@ pnl_dock_manager_class_init (PnlDockManagerClass *klass)
   klass->register_dock = pnl_dock_manager_real_register_dock;
   klass->unregister_dock = pnl_dock_manager_real_unregister_dock;
 
+  properties [PROP_HIBERNATE_BUDGET] =
+    g_param_spec_uint64 ("hibernate-budget",
+                         "Hibernate Budget",
+                         "The estimated number of bytes hidden dock widgets may keep, or 0 for no limit",
+                         0,
+                         G_MAXUINT64,
+                         0,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_HIBERNATE_DELAY] =
+    g_param_spec_uint ("hibernate-delay",
+                       "Hibernate Delay",
+                       "The number of seconds a dock widget may be hidden before it is hibernated, or 0 to never",
+                       0,
+                       G_MAXUINT,
+                       0,
+                       (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  /**
+   * PnlDockManager::item-added:
+   * @self: A #PnlDockManager
+   * @item: the #PnlDockItem
+   *
+   * Emitted when @item is given this manager, such as when it is added to
+   * a dock managed by @self.
+   */
+  signals [ITEM_ADDED] =
+    g_signal_new ("item-added",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, PNL_TYPE_DOCK_ITEM);
+
+  /**
+   * PnlDockManager::item-removed:
+   * @self: A #PnlDockManager
+   * @item: the #PnlDockItem
+   *
+   * Emitted when @item is destroyed or moved to another manager.
+   */
+  signals [ITEM_REMOVED] =
+    g_signal_new ("item-removed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, PNL_TYPE_DOCK_ITEM);
+
   signals [REGISTER_DOCK] =
     g_signal_new ("register-dock",
                   G_TYPE_FROM_CLASS (klass),
@@ -161,6 +698,13 @@ pnl_dock_manager_init (PnlDockManager *self)
   PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
 
   priv->docks = g_ptr_array_new ();
+  priv->dock_index = g_hash_table_new (NULL, NULL);
+  priv->items = g_ptr_array_new ();
+  priv->item_index = g_hash_table_new (NULL, NULL);
+  priv->items_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->transaction_items = g_ptr_array_new_with_free_func (g_object_unref);
+  priv->pending_visibility = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+  g_queue_init (&priv->hidden);
 }
 
 PnlDockManager *
@@ -188,3 +732,276 @@ pnl_dock_manager_unregister_dock (PnlDockManager *self,
 
   g_signal_emit (self, signals [UNREGISTER_DOCK], 0, dock);
 }
+
+guint64
+pnl_dock_manager_get_hibernate_budget (PnlDockManager *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), 0);
+
+  return priv->hibernate_budget;
+}
+
+/**
+ * pnl_dock_manager_set_hibernate_budget:
+ * @self: A #PnlDockManager
+ * @hibernate_budget: a size in bytes, or 0
+ *
+ * Sets how much memory hidden dock widgets may hold on to before the
+ * least recently shown ones are hibernated. The cost of a hidden widget
+ * is estimated from its last allocation.
+ *
+ * Hibernating a #PnlDockWidget unrealizes its child, or destroys it if
+ * it was created from a factory such as with pnl_dock_stack_add_lazy().
+ * The child is realized or rebuilt when the widget is shown again.
+ */
+void
+pnl_dock_manager_set_hibernate_budget (PnlDockManager *self,
+                                       guint64         hibernate_budget)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+
+  if (priv->hibernate_budget != hibernate_budget)
+    {
+      priv->hibernate_budget = hibernate_budget;
+      if (priv->hidden.head != NULL)
+        pnl_dock_manager_queue_hibernate (self, 0);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_HIBERNATE_BUDGET]);
+    }
+}
+
+guint
+pnl_dock_manager_get_hibernate_delay (PnlDockManager *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), 0);
+
+  return priv->hibernate_delay;
+}
+
+/**
+ * pnl_dock_manager_set_hibernate_delay:
+ * @self: A #PnlDockManager
+ * @hibernate_delay: a number of seconds, or 0
+ *
+ * Sets how long a dock widget may stay hidden before it is hibernated.
+ * See pnl_dock_manager_set_hibernate_budget() for what that means.
+ */
+void
+pnl_dock_manager_set_hibernate_delay (PnlDockManager *self,
+                                      guint           hibernate_delay)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+
+  if (priv->hibernate_delay != hibernate_delay)
+    {
+      priv->hibernate_delay = hibernate_delay;
+      if (priv->hidden.head != NULL)
+        pnl_dock_manager_queue_hibernate (self, 0);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_HIBERNATE_DELAY]);
+    }
+}
+
+/**
+ * pnl_dock_manager_get_n_items:
+ * @self: A #PnlDockManager
+ *
+ * Returns: the number of dock items using @self.
+ */
+guint
+pnl_dock_manager_get_n_items (PnlDockManager *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), 0);
+
+  return priv->items->len;
+}
+
+/**
+ * pnl_dock_manager_has_item:
+ * @self: A #PnlDockManager
+ * @item: A #PnlDockItem
+ *
+ * Returns: %TRUE if @item is using @self.
+ */
+gboolean
+pnl_dock_manager_has_item (PnlDockManager *self,
+                           PnlDockItem    *item)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), FALSE);
+  g_return_val_if_fail (PNL_IS_DOCK_ITEM (item), FALSE);
+
+  return g_hash_table_contains (priv->item_index, item);
+}
+
+/**
+ * pnl_dock_manager_lookup_item:
+ * @self: A #PnlDockManager
+ * @id: an identifier set with pnl_dock_item_set_id()
+ *
+ * Finds a dock item by identifier, in any of the windows using @self.
+ * Use pnl_dock_item_present() to bring it in front of the user.
+ *
+ * Returns: (transfer none) (nullable): a #PnlDockItem or %NULL.
+ */
+PnlDockItem *
+pnl_dock_manager_lookup_item (PnlDockManager *self,
+                              const gchar    *id)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (self), NULL);
+  g_return_val_if_fail (id != NULL, NULL);
+
+  return g_hash_table_lookup (priv->items_by_id, id);
+}
+
+/**
+ * pnl_dock_manager_iter_init:
+ * @iter: an uninitialized #PnlDockManagerIter
+ * @self: A #PnlDockManager
+ *
+ * Initializes @iter to walk the dock items using @self. Items must not
+ * be added to or removed from @self while iterating.
+ *
+ * |[<!-- language="C" -->
+ * PnlDockManagerIter iter;
+ * PnlDockItem *item;
+ *
+ * pnl_dock_manager_iter_init (&iter, manager);
+ * while (pnl_dock_manager_iter_next (&iter, &item))
+ *   do_something (item);
+ * ]|
+ */
+void
+pnl_dock_manager_iter_init (PnlDockManagerIter *iter,
+                            PnlDockManager     *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+
+  iter->manager = self;
+  iter->position = 0;
+  iter->n_items = priv->items->len;
+}
+
+/**
+ * pnl_dock_manager_iter_next:
+ * @iter: A #PnlDockManagerIter
+ * @item: (out) (optional) (transfer none): a location for the item
+ *
+ * Advances @iter to the next dock item.
+ *
+ * Returns: %FALSE once there are no more items.
+ */
+gboolean
+pnl_dock_manager_iter_next (PnlDockManagerIter  *iter,
+                            PnlDockItem        **item)
+{
+  PnlDockManagerPrivate *priv;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (PNL_IS_DOCK_MANAGER (iter->manager), FALSE);
+
+  priv = pnl_dock_manager_get_instance_private (iter->manager);
+
+  g_return_val_if_fail (iter->n_items == priv->items->len, FALSE);
+
+  if (iter->position >= priv->items->len)
+    return FALSE;
+
+  if (item != NULL)
+    *item = g_ptr_array_index (priv->items, iter->position);
+
+  iter->position++;
+
+  return TRUE;
+}
+
+/**
+ * pnl_dock_manager_begin_transaction:
+ * @self: A #PnlDockManager
+ *
+ * Starts a batch of changes to the docks using @self, such as moving
+ * many panels around to apply a different perspective.
+ *
+ * Until the matching pnl_dock_manager_commit_transaction(), every dock
+ * item using @self (including the ones added in the meantime) defers
+ * child property notifications, panes keep their positions instead of
+ * being laid out again for every child added or removed, and visibility
+ * updates are not propagated. All of that happens once at commit.
+ *
+ * Transactions may be nested; only the outermost commit applies them.
+ */
+void
+pnl_dock_manager_begin_transaction (PnlDockManager *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  guint i;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+
+  if (priv->transaction_depth++ > 0)
+    return;
+
+  for (i = 0; i < priv->items->len; i++)
+    pnl_dock_manager_suspend_item (self, g_ptr_array_index (priv->items, i));
+}
+
+/**
+ * pnl_dock_manager_commit_transaction:
+ * @self: A #PnlDockManager
+ *
+ * Completes a transaction started with pnl_dock_manager_begin_transaction().
+ */
+void
+pnl_dock_manager_commit_transaction (PnlDockManager *self)
+{
+  PnlDockManagerPrivate *priv = pnl_dock_manager_get_instance_private (self);
+  GHashTableIter iter;
+  GHashTable *pending;
+  GPtrArray *items;
+  gpointer key;
+  guint i;
+
+  g_return_if_fail (PNL_IS_DOCK_MANAGER (self));
+  g_return_if_fail (priv->transaction_depth > 0);
+
+  if (--priv->transaction_depth > 0)
+    return;
+
+  /* Swap in fresh containers, thawing may open another transaction. */
+  items = priv->transaction_items;
+  priv->transaction_items = g_ptr_array_new_with_free_func (g_object_unref);
+  pending = priv->pending_visibility;
+  priv->pending_visibility = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+
+  for (i = 0; i < items->len; i++)
+    {
+      PnlDockItem *item = g_ptr_array_index (items, i);
+
+      if (PNL_IS_MULTI_PANED (item))
+        pnl_multi_paned_thaw_layout (PNL_MULTI_PANED (item));
+    }
+
+  g_hash_table_iter_init (&iter, pending);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    pnl_dock_item_update_visibility (key);
+
+  for (i = 0; i < items->len; i++)
+    gtk_widget_thaw_child_notify (g_ptr_array_index (items, i));
+
+  g_hash_table_unref (pending);
+  g_ptr_array_unref (items);
+}
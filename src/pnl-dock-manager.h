@@ -27,6 +27,14 @@
 
 G_BEGIN_DECLS
 
+typedef struct
+{
+  /*< private >*/
+  PnlDockManager *manager;
+  guint           position;
+  guint           n_items;
+} PnlDockManagerIter;
+
 struct _PnlDockManagerClass
 {
   GObjectClass parent;
@@ -37,11 +45,28 @@ struct _PnlDockManagerClass
                            PnlDock        *dock);
 };
 
-PnlDockManager *pnl_dock_manager_new             (void);
-void            pnl_dock_manager_register_dock   (PnlDockManager *self,
-                                                  PnlDock        *dock);
-void            pnl_dock_manager_unregister_dock (PnlDockManager *self,
-                                                  PnlDock        *dock);
+PnlDockManager *pnl_dock_manager_new                  (void);
+void            pnl_dock_manager_register_dock        (PnlDockManager      *self,
+                                                       PnlDock             *dock);
+void            pnl_dock_manager_unregister_dock      (PnlDockManager      *self,
+                                                       PnlDock             *dock);
+guint64         pnl_dock_manager_get_hibernate_budget (PnlDockManager      *self);
+void            pnl_dock_manager_set_hibernate_budget (PnlDockManager      *self,
+                                                       guint64              hibernate_budget);
+guint           pnl_dock_manager_get_hibernate_delay  (PnlDockManager      *self);
+void            pnl_dock_manager_set_hibernate_delay  (PnlDockManager      *self,
+                                                       guint                hibernate_delay);
+guint           pnl_dock_manager_get_n_items          (PnlDockManager      *self);
+gboolean        pnl_dock_manager_has_item             (PnlDockManager      *self,
+                                                       PnlDockItem         *item);
+PnlDockItem    *pnl_dock_manager_lookup_item          (PnlDockManager      *self,
+                                                       const gchar         *id);
+void            pnl_dock_manager_iter_init            (PnlDockManagerIter  *iter,
+                                                       PnlDockManager      *self);
+gboolean        pnl_dock_manager_iter_next            (PnlDockManagerIter  *iter,
+                                                       PnlDockItem        **item);
+void            pnl_dock_manager_begin_transaction    (PnlDockManager      *self);
+void            pnl_dock_manager_commit_transaction   (PnlDockManager      *self);
 
 G_END_DECLS
 
@@ -19,9 +19,12 @@
 #include "pnl-animation.h"
 #include "pnl-dock-overlay-edge-private.h"
 #include "pnl-dock-item.h"
+#include "pnl-dock-item-private.h"
 #include "pnl-dock-overlay.h"
+#include "pnl-dock-private.h"
 #include "pnl-tab.h"
 #include "pnl-tab-strip.h"
+#include "pnl-trace-private.h"
 #include "pnl-util-private.h"
 
 #define REVEAL_DURATION 300
@@ -186,6 +189,8 @@ pnl_dock_overlay_get_child_position (GtkOverlay    *overlay,
                                      GtkAllocation *allocation)
 {
   PnlDockOverlay *self = (PnlDockOverlay *)overlay;
+  gboolean ret;
+  PNL_TRACE_BEGIN;
 
   g_assert (GTK_IS_OVERLAY (overlay));
   g_assert (GTK_IS_WIDGET (widget));
@@ -194,11 +199,43 @@ pnl_dock_overlay_get_child_position (GtkOverlay    *overlay,
   if (PNL_IS_DOCK_OVERLAY_EDGE (widget))
     {
       pnl_dock_overlay_get_edge_position (self, PNL_DOCK_OVERLAY_EDGE (widget), allocation);
+      PNL_TRACE_END ("PnlDockOverlay.get_child_position");
       return TRUE;
     }
 
-  return GTK_OVERLAY_CLASS (pnl_dock_overlay_parent_class)->get_child_position (overlay, widget, allocation);
+  ret = GTK_OVERLAY_CLASS (pnl_dock_overlay_parent_class)->get_child_position (overlay, widget, allocation);
+
+  PNL_TRACE_END ("PnlDockOverlay.get_child_position");
+
+  return ret;
+}
+
+#ifdef PNL_ENABLE_TRACING
+static void
+pnl_dock_overlay_size_allocate (GtkWidget     *widget,
+                                GtkAllocation *allocation)
+{
+  PNL_TRACE_BEGIN;
+
+  GTK_WIDGET_CLASS (pnl_dock_overlay_parent_class)->size_allocate (widget, allocation);
+
+  PNL_TRACE_END ("PnlDockOverlay.size_allocate");
+}
+
+static gboolean
+pnl_dock_overlay_draw (GtkWidget *widget,
+                       cairo_t   *cr)
+{
+  gboolean ret;
+  PNL_TRACE_BEGIN;
+
+  ret = GTK_WIDGET_CLASS (pnl_dock_overlay_parent_class)->draw (widget, cr);
+
+  PNL_TRACE_END ("PnlDockOverlay.draw");
+
+  return ret;
 }
+#endif
 
 static void
 pnl_dock_overlay_add (GtkContainer *container,
@@ -216,7 +253,7 @@ pnl_dock_overlay_add (GtkContainer *container,
   if (PNL_IS_DOCK_ITEM (widget))
     {
       pnl_dock_item_adopt (PNL_DOCK_ITEM (self), PNL_DOCK_ITEM (widget));
-      pnl_dock_item_update_visibility (PNL_DOCK_ITEM (widget));
+      pnl_dock_item_queue_update_visibility (PNL_DOCK_ITEM (widget));
     }
 }
 
@@ -408,16 +445,22 @@ pnl_dock_overlay_set_child_reveal (PnlDockOverlay *self,
     {
       priv->child_reveal = child_reveal;
 
-      pnl_object_animate (priv->edge_adj [edge],
-                          PNL_ANIMATION_EASE_IN_OUT_CUBIC,
-                          REVEAL_DURATION,
-                          gtk_widget_get_frame_clock (child),
-                          "value", reveal ? 0.0 : 1.0,
-                          NULL);
+      /* Nothing to animate until we are shown, such as when restoring a layout. */
+      if (gtk_widget_get_mapped (child))
+        pnl_object_animate (priv->edge_adj [edge],
+                            PNL_ANIMATION_EASE_IN_OUT_CUBIC,
+                            REVEAL_DURATION,
+                            gtk_widget_get_frame_clock (child),
+                            "value", reveal ? 0.0 : 1.0,
+                            NULL);
+      else
+        gtk_adjustment_set_value (priv->edge_adj [edge], reveal ? 0.0 : 1.0);
 
       gtk_container_child_notify_by_pspec (GTK_CONTAINER (self),
                                            child,
                                            child_properties [CHILD_PROP_REVEAL]);
+
+      pnl_dock_queue_autosave (GTK_WIDGET (self));
     }
 
 }
@@ -514,6 +557,10 @@ pnl_dock_overlay_class_init (PnlDockOverlayClass *klass)
 
   widget_class->destroy = pnl_dock_overlay_destroy;
   widget_class->hierarchy_changed = pnl_dock_overlay_hierarchy_changed;
+#ifdef PNL_ENABLE_TRACING
+  widget_class->size_allocate = pnl_dock_overlay_size_allocate;
+  widget_class->draw = pnl_dock_overlay_draw;
+#endif
 
   container_class->add = pnl_dock_overlay_add;
   container_class->get_child_property = pnl_dock_overlay_get_child_property;
@@ -667,6 +714,7 @@ pnl_dock_overlay_update_visibility (PnlDockItem *item)
 {
   PnlDockOverlay *self = (PnlDockOverlay *)item;
   PnlDockOverlayPrivate *priv = pnl_dock_overlay_get_instance_private (self);
+  gboolean changed = FALSE;
   guint i;
 
   g_assert (PNL_IS_DOCK_OVERLAY (self));
@@ -681,10 +729,15 @@ pnl_dock_overlay_update_visibility (PnlDockItem *item)
 
       has_widgets = pnl_dock_item_has_widgets (PNL_DOCK_ITEM (edge));
 
-      gtk_widget_set_child_visible (GTK_WIDGET (edge), has_widgets);
+      if (has_widgets != gtk_widget_get_child_visible (GTK_WIDGET (edge)))
+        {
+          gtk_widget_set_child_visible (GTK_WIDGET (edge), has_widgets);
+          changed = TRUE;
+        }
     }
 
-  gtk_widget_queue_resize (GTK_WIDGET (self));
+  if (changed)
+    gtk_widget_queue_resize (GTK_WIDGET (self));
 }
 
 static void
@@ -17,6 +17,7 @@
  */
 
 #include "pnl-dock-item.h"
+#include "pnl-dock-private.h"
 #include "pnl-dock-paned.h"
 #include "pnl-dock-paned-private.h"
 #include "pnl-dock-stack.h"
@@ -48,6 +49,18 @@ pnl_dock_paned_add (GtkContainer *container,
     pnl_dock_item_adopt (PNL_DOCK_ITEM (self), PNL_DOCK_ITEM (widget));
 }
 
+static void
+pnl_dock_paned_resize_drag_end (PnlMultiPaned *multi_paned,
+                                GtkWidget     *child)
+{
+  g_assert (PNL_IS_DOCK_PANED (multi_paned));
+  g_assert (GTK_IS_WIDGET (child));
+
+  PNL_MULTI_PANED_CLASS (pnl_dock_paned_parent_class)->resize_drag_end (multi_paned, child);
+
+  pnl_dock_queue_autosave (GTK_WIDGET (multi_paned));
+}
+
 static void
 pnl_dock_paned_get_property (GObject    *object,
                              guint       prop_id,
@@ -80,12 +93,15 @@ pnl_dock_paned_class_init (PnlDockPanedClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   GtkContainerClass *container_class = GTK_CONTAINER_CLASS (klass);
+  PnlMultiPanedClass *multi_paned_class = PNL_MULTI_PANED_CLASS (klass);
 
   object_class->get_property = pnl_dock_paned_get_property;
   object_class->set_property = pnl_dock_paned_set_property;
 
   container_class->add = pnl_dock_paned_add;
 
+  multi_paned_class->resize_drag_end = pnl_dock_paned_resize_drag_end;
+
   gtk_widget_class_set_css_name (widget_class, "dockpaned");
 }
 
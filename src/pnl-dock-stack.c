@@ -17,8 +17,9 @@
  */
 
 #include "pnl-dock-item.h"
+#include "pnl-dock-private.h"
 #include "pnl-dock-stack.h"
-#include "pnl-dock-widget.h"
+#include "pnl-dock-widget-private.h"
 #include "pnl-tab-strip.h"
 
 typedef struct
@@ -28,6 +29,17 @@ typedef struct
   GtkPositionType   edge : 2;
 } PnlDockStackPrivate;
 
+/*
+ * Closure for pages added with pnl_dock_stack_add_lazy(). It is owned by
+ * the page so that the content can be rebuilt after hibernation.
+ */
+typedef struct
+{
+  PnlDockStackPageFactory factory;
+  gpointer                user_data;
+  GDestroyNotify          user_data_destroy;
+} PnlDockStackLazyPage;
+
 static void pnl_dock_stack_init_dock_item_iface (PnlDockItemInterface *iface);
 
 G_DEFINE_TYPE_EXTENDED (PnlDockStack, pnl_dock_stack, GTK_TYPE_BOX, 0,
@@ -43,6 +55,68 @@ enum {
 
 static GParamSpec *properties [N_PROPS];
 
+static void
+pnl_dock_stack_lazy_page_free (gpointer data)
+{
+  PnlDockStackLazyPage *lazy = data;
+
+  if (lazy->user_data_destroy != NULL)
+    lazy->user_data_destroy (lazy->user_data);
+
+  g_slice_free (PnlDockStackLazyPage, lazy);
+}
+
+static GtkWidget *
+pnl_dock_stack_build_page (PnlDockWidget *page,
+                           gpointer       user_data)
+{
+  PnlDockStackLazyPage *lazy = user_data;
+  GtkWidget *self;
+
+  g_assert (PNL_IS_DOCK_WIDGET (page));
+  g_assert (lazy != NULL);
+
+  self = gtk_widget_get_ancestor (GTK_WIDGET (page), PNL_TYPE_DOCK_STACK);
+
+  if (self == NULL)
+    return NULL;
+
+  return lazy->factory (PNL_DOCK_STACK (self), page, lazy->user_data);
+}
+
+/*
+ * Builds the content of a lazy page if it does not exist yet. The
+ * placeholder stays in the stack, so the tab and position are unchanged.
+ */
+static void
+pnl_dock_stack_ensure_page (PnlDockStack *self,
+                            GtkWidget    *page)
+{
+  g_assert (PNL_IS_DOCK_STACK (self));
+  g_assert (GTK_IS_WIDGET (page));
+
+  if (PNL_IS_DOCK_WIDGET (page))
+    pnl_dock_widget_ensure_child (PNL_DOCK_WIDGET (page));
+}
+
+static void
+pnl_dock_stack_notify_visible_child (PnlDockStack *self,
+                                     GParamSpec   *pspec,
+                                     GtkStack     *stack)
+{
+  GtkWidget *visible;
+
+  g_assert (PNL_IS_DOCK_STACK (self));
+  g_assert (GTK_IS_STACK (stack));
+
+  visible = gtk_stack_get_visible_child (stack);
+
+  if (visible != NULL)
+    pnl_dock_stack_ensure_page (self, visible);
+
+  pnl_dock_queue_autosave (GTK_WIDGET (self));
+}
+
 static void
 pnl_dock_stack_add (GtkContainer *container,
                     GtkWidget    *widget)
@@ -160,6 +234,12 @@ pnl_dock_stack_init (PnlDockStack *self)
                               "visible", TRUE,
                               NULL);
 
+  g_signal_connect_object (priv->stack,
+                           "notify::visible-child",
+                           G_CALLBACK (pnl_dock_stack_notify_visible_child),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   priv->tab_strip = g_object_new (PNL_TYPE_TAB_STRIP,
                                   "edge", GTK_POS_TOP,
                                   "stack", priv->stack,
@@ -178,6 +258,57 @@ pnl_dock_stack_new (void)
   return g_object_new (PNL_TYPE_DOCK_STACK, NULL);
 }
 
+/**
+ * pnl_dock_stack_add_lazy:
+ * @self: A #PnlDockStack
+ * @title: the title for the page
+ * @factory: (scope notified): a function to build the page content
+ * @user_data: closure data for @factory
+ * @user_data_destroy: called when @user_data is no longer needed
+ *
+ * Adds a page whose content is built on demand. A #PnlDockWidget with
+ * @title is added right away so that the page gets its tab, and @factory
+ * is called to create its child the first time the page is shown or
+ * presented.
+ *
+ * If the #PnlDockManager hibernates the page while it is hidden, the
+ * content is destroyed and @factory is called again when needed.
+ *
+ * Returns: (transfer none): the #PnlDockWidget placeholder for the page.
+ */
+PnlDockWidget *
+pnl_dock_stack_add_lazy (PnlDockStack            *self,
+                         const gchar             *title,
+                         PnlDockStackPageFactory  factory,
+                         gpointer                 user_data,
+                         GDestroyNotify           user_data_destroy)
+{
+  PnlDockStackLazyPage *lazy;
+  GtkWidget *page;
+
+  g_return_val_if_fail (PNL_IS_DOCK_STACK (self), NULL);
+  g_return_val_if_fail (factory != NULL, NULL);
+
+  lazy = g_slice_new0 (PnlDockStackLazyPage);
+  lazy->factory = factory;
+  lazy->user_data = user_data;
+  lazy->user_data_destroy = user_data_destroy;
+
+  page = g_object_new (PNL_TYPE_DOCK_WIDGET,
+                       "title", title,
+                       "visible", TRUE,
+                       NULL);
+
+  pnl_dock_widget_set_factory (PNL_DOCK_WIDGET (page),
+                               pnl_dock_stack_build_page,
+                               lazy,
+                               pnl_dock_stack_lazy_page_free);
+
+  gtk_container_add (GTK_CONTAINER (self), page);
+
+  return PNL_DOCK_WIDGET (page);
+}
+
 GtkPositionType
 pnl_dock_stack_get_edge (PnlDockStack *self)
 {
@@ -264,6 +395,8 @@ pnl_dock_stack_present_child (PnlDockItem *item,
   g_assert (PNL_IS_DOCK_STACK (self));
   g_assert (PNL_IS_DOCK_ITEM (child));
 
+  pnl_dock_stack_ensure_page (self, GTK_WIDGET (child));
+
   gtk_stack_set_visible_child (priv->stack, GTK_WIDGET (child));
 }
 
@@ -32,10 +32,29 @@ struct _PnlDockStackClass
   GtkBoxClass parent;
 };
 
+/**
+ * PnlDockStackPageFactory:
+ * @self: the #PnlDockStack
+ * @page: the placeholder page to fill
+ * @user_data: closure data
+ *
+ * Builds the content for a page added with pnl_dock_stack_add_lazy().
+ *
+ * Returns: (transfer floating) (nullable): the child for @page.
+ */
+typedef GtkWidget *(*PnlDockStackPageFactory) (PnlDockStack  *self,
+                                               PnlDockWidget *page,
+                                               gpointer       user_data);
+
 GtkWidget       *pnl_dock_stack_new      (void);
 GtkPositionType  pnl_dock_stack_get_edge (PnlDockStack    *self);
 void             pnl_dock_stack_set_edge (PnlDockStack    *self,
                                           GtkPositionType  edge);
+PnlDockWidget   *pnl_dock_stack_add_lazy (PnlDockStack            *self,
+                                          const gchar             *title,
+                                          PnlDockStackPageFactory  factory,
+                                          gpointer                 user_data,
+                                          GDestroyNotify           user_data_destroy);
 
 G_END_DECLS
 
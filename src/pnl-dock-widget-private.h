@@ -0,0 +1,41 @@
+/* pnl-dock-widget-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PNL_DOCK_WIDGET_PRIVATE_H
+#define PNL_DOCK_WIDGET_PRIVATE_H
+
+#include "pnl-dock-widget.h"
+
+G_BEGIN_DECLS
+
+typedef GtkWidget *(*PnlDockWidgetFactory) (PnlDockWidget *self,
+                                            gpointer       user_data);
+
+void     pnl_dock_widget_set_factory      (PnlDockWidget        *self,
+                                           PnlDockWidgetFactory  factory,
+                                           gpointer              user_data,
+                                           GDestroyNotify        user_data_destroy);
+void     pnl_dock_widget_ensure_child     (PnlDockWidget        *self);
+gboolean pnl_dock_widget_hibernate        (PnlDockWidget        *self);
+gpointer pnl_dock_widget_get_hidden_entry (PnlDockWidget        *self);
+void     pnl_dock_widget_set_hidden_entry (PnlDockWidget        *self,
+                                           gpointer              entry);
+
+G_END_DECLS
+
+#endif /* PNL_DOCK_WIDGET_PRIVATE_H */
@@ -17,12 +17,28 @@
  */
 
 #include "pnl-dock-item.h"
-#include "pnl-dock-widget.h"
+#include "pnl-dock-manager-private.h"
+#include "pnl-dock-widget-private.h"
 #include "pnl-util-private.h"
 
 typedef struct
 {
-  gchar *title;
+  gchar                *title;
+
+  /*
+   * If set, the child is built on demand and can be thrown away while
+   * the widget is hidden (see pnl_dock_widget_hibernate()).
+   */
+  PnlDockWidgetFactory  factory;
+  gpointer              factory_data;
+  GDestroyNotify        factory_data_destroy;
+
+  /*
+   * The entry of the PnlDockManager hidden queue tracking us while we
+   * are hidden, so that it can be removed without scanning the queue.
+   * Owned by the manager.
+   */
+  gpointer              hidden_entry;
 } PnlDockWidgetPrivate;
 
 G_DEFINE_TYPE_EXTENDED (PnlDockWidget, pnl_dock_widget, GTK_TYPE_BIN, 0,
@@ -54,6 +70,37 @@ pnl_dock_widget_grab_focus (GtkWidget *widget)
     gtk_widget_child_focus (child, GTK_DIR_TAB_FORWARD);
 }
 
+static void
+pnl_dock_widget_map (GtkWidget *widget)
+{
+  PnlDockWidget *self = (PnlDockWidget *)widget;
+  PnlDockManager *manager;
+
+  g_assert (PNL_IS_DOCK_WIDGET (self));
+
+  /* Rebuild the child before it would be mapped along with us. */
+  pnl_dock_widget_ensure_child (self);
+
+  GTK_WIDGET_CLASS (pnl_dock_widget_parent_class)->map (widget);
+
+  if (NULL != (manager = pnl_dock_item_get_manager (PNL_DOCK_ITEM (self))))
+    pnl_dock_manager_widget_shown (manager, self);
+}
+
+static void
+pnl_dock_widget_unmap (GtkWidget *widget)
+{
+  PnlDockWidget *self = (PnlDockWidget *)widget;
+  PnlDockManager *manager;
+
+  g_assert (PNL_IS_DOCK_WIDGET (self));
+
+  GTK_WIDGET_CLASS (pnl_dock_widget_parent_class)->unmap (widget);
+
+  if (NULL != (manager = pnl_dock_item_get_manager (PNL_DOCK_ITEM (self))))
+    pnl_dock_manager_widget_hidden (manager, self);
+}
+
 static void
 pnl_dock_widget_finalize (GObject *object)
 {
@@ -62,6 +109,9 @@ pnl_dock_widget_finalize (GObject *object)
 
   g_clear_pointer (&priv->title, g_free);
 
+  if (priv->factory_data_destroy != NULL)
+    g_clear_pointer (&priv->factory_data, priv->factory_data_destroy);
+
   G_OBJECT_CLASS (pnl_dock_widget_parent_class)->finalize (object);
 }
 
@@ -123,6 +173,8 @@ pnl_dock_widget_class_init (PnlDockWidgetClass *klass)
 
   widget_class->draw = pnl_gtk_bin_draw;
   widget_class->grab_focus = pnl_dock_widget_grab_focus;
+  widget_class->map = pnl_dock_widget_map;
+  widget_class->unmap = pnl_dock_widget_unmap;
   widget_class->size_allocate = pnl_gtk_bin_size_allocate;
 
   properties [PROP_MANAGER] =
@@ -182,3 +234,104 @@ pnl_dock_widget_set_title (PnlDockWidget *self,
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_TITLE]);
     }
 }
+
+/*
+ * pnl_dock_widget_set_factory:
+ *
+ * Sets a function used to build the child of @self. The child is built
+ * the next time the widget is mapped or pnl_dock_widget_ensure_child()
+ * is called, and again after the widget has been hibernated.
+ */
+void
+pnl_dock_widget_set_factory (PnlDockWidget        *self,
+                             PnlDockWidgetFactory  factory,
+                             gpointer              user_data,
+                             GDestroyNotify        user_data_destroy)
+{
+  PnlDockWidgetPrivate *priv = pnl_dock_widget_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_DOCK_WIDGET (self));
+
+  if (priv->factory_data_destroy != NULL)
+    g_clear_pointer (&priv->factory_data, priv->factory_data_destroy);
+
+  priv->factory = factory;
+  priv->factory_data = user_data;
+  priv->factory_data_destroy = user_data_destroy;
+}
+
+void
+pnl_dock_widget_ensure_child (PnlDockWidget *self)
+{
+  PnlDockWidgetPrivate *priv = pnl_dock_widget_get_instance_private (self);
+  GtkWidget *child;
+
+  g_return_if_fail (PNL_IS_DOCK_WIDGET (self));
+
+  if (priv->factory == NULL || gtk_bin_get_child (GTK_BIN (self)) != NULL)
+    return;
+
+  child = priv->factory (self, priv->factory_data);
+
+  if (child != NULL)
+    gtk_container_add (GTK_CONTAINER (self), child);
+}
+
+/*
+ * pnl_dock_widget_hibernate:
+ *
+ * Releases the resources held by the child of a hidden dock widget. If
+ * the child can be rebuilt from a factory it is destroyed, otherwise it
+ * is only unrealized and will be realized again when shown.
+ *
+ * Returns: %TRUE if the child was destroyed or unrealized.
+ */
+gboolean
+pnl_dock_widget_hibernate (PnlDockWidget *self)
+{
+  PnlDockWidgetPrivate *priv = pnl_dock_widget_get_instance_private (self);
+  GtkWidget *child;
+
+  g_return_val_if_fail (PNL_IS_DOCK_WIDGET (self), FALSE);
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    return FALSE;
+
+  if (NULL == (child = gtk_bin_get_child (GTK_BIN (self))))
+    return FALSE;
+
+  if (priv->factory != NULL)
+    {
+      gtk_widget_destroy (child);
+      return TRUE;
+    }
+
+  if (gtk_widget_get_realized (child))
+    {
+      gtk_widget_unrealize (child);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+gpointer
+pnl_dock_widget_get_hidden_entry (PnlDockWidget *self)
+{
+  PnlDockWidgetPrivate *priv = pnl_dock_widget_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_DOCK_WIDGET (self), NULL);
+
+  return priv->hidden_entry;
+}
+
+void
+pnl_dock_widget_set_hidden_entry (PnlDockWidget *self,
+                                  gpointer       entry)
+{
+  PnlDockWidgetPrivate *priv = pnl_dock_widget_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_DOCK_WIDGET (self));
+
+  priv->hidden_entry = entry;
+}
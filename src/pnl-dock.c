@@ -17,13 +17,59 @@
  */
 
 #include "pnl-dock.h"
+#include "pnl-dock-private.h"
+#include "pnl-dock-bin.h"
+#include "pnl-dock-bin-edge-private.h"
+#include "pnl-dock-item.h"
+#include "pnl-dock-overlay.h"
+#include "pnl-dock-overlay-edge-private.h"
+#include "pnl-dock-widget.h"
 #include "pnl-resources.h"
 
+/*
+ * The layout is stored as (uv), the version followed by the root node.
+ * Each node is (sa{sv}av): the type name of the widget, its layout
+ * properties and the nodes found below it. Only dock items and bin
+ * edges become nodes; the containers in between them (such as the
+ * GtkStack of a PnlDockStack) are walked through transparently, and
+ * the content of a PnlDockWidget is never looked at.
+ */
+#define LAYOUT_VERSION   1
+#define NODE_TYPE_STRING "(sa{sv}av)"
+
+/*
+ * Layout changes tend to arrive in bursts (revealing an edge, then
+ * dragging it, then switching pages) so we wait a bit before saving.
+ */
+#define AUTOSAVE_DELAY_MSEC 500
+
+typedef struct
+{
+  PnlDock      *dock;
+  GFile        *file;
+  GCancellable *cancellable;
+  guint         source;
+
+  /* A write is running, and if another one is needed after it. */
+  guint         in_flight : 1;
+  guint         dirty : 1;
+} PnlDockAutosave;
+
+typedef struct
+{
+  GFile  *file;
+  GBytes *bytes;
+} PnlDockAutosaveWrite;
+
+static GQuark autosave_quark;
+
 G_DEFINE_INTERFACE (PnlDock, pnl_dock, GTK_TYPE_CONTAINER)
 
 static void
 pnl_dock_default_init (PnlDockInterface *iface)
 {
+  autosave_quark = g_quark_from_static_string ("PNL_DOCK_AUTOSAVE");
+
   g_resources_register (pnl_get_resource ());
   gtk_icon_theme_add_resource_path (gtk_icon_theme_get_default (),
                                     "/org/gnome/panel-gtk/icons");
@@ -35,3 +81,557 @@ pnl_dock_default_init (PnlDockInterface *iface)
                                                             PNL_TYPE_DOCK_MANAGER,
                                                             (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 }
+
+static gboolean
+pnl_dock_is_layout_node (GtkWidget *widget)
+{
+  return PNL_IS_DOCK_ITEM (widget) || PNL_IS_DOCK_BIN_EDGE (widget);
+}
+
+static void
+pnl_dock_collect_nodes (GtkWidget *widget,
+                        gpointer   user_data)
+{
+  GPtrArray *nodes = user_data;
+
+  if (pnl_dock_is_layout_node (widget))
+    g_ptr_array_add (nodes, widget);
+  else if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), pnl_dock_collect_nodes, nodes);
+}
+
+static GPtrArray *
+pnl_dock_get_child_nodes (GtkWidget *widget)
+{
+  GPtrArray *nodes = g_ptr_array_new ();
+
+  if (GTK_IS_CONTAINER (widget) && !PNL_IS_DOCK_WIDGET (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), pnl_dock_collect_nodes, nodes);
+
+  return nodes;
+}
+
+static GVariant *
+pnl_dock_save_node (GtkWidget *widget)
+{
+  GVariantBuilder props;
+  GVariantBuilder children;
+  GtkWidget *parent;
+  GPtrArray *nodes;
+  guint i;
+
+  g_assert (GTK_IS_WIDGET (widget));
+
+  g_variant_builder_init (&props, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_init (&children, G_VARIANT_TYPE ("av"));
+
+  parent = gtk_widget_get_parent (widget);
+
+  if (PNL_IS_MULTI_PANED (parent) || PNL_IS_DOCK_BIN (parent))
+    {
+      const gchar *name = PNL_IS_DOCK_BIN (parent) ? "priority" : "position";
+      gint value = 0;
+
+      gtk_container_child_get (GTK_CONTAINER (parent), widget, name, &value, NULL);
+      g_variant_builder_add (&props, "{sv}", name, g_variant_new_int32 (value));
+    }
+  else if (PNL_IS_DOCK_OVERLAY (parent))
+    {
+      gboolean reveal = FALSE;
+
+      gtk_container_child_get (GTK_CONTAINER (parent), widget, "reveal", &reveal, NULL);
+      g_variant_builder_add (&props, "{sv}", "reveal", g_variant_new_boolean (reveal));
+    }
+  else if (GTK_IS_STACK (parent))
+    {
+      if (gtk_stack_get_visible_child (GTK_STACK (parent)) == widget)
+        g_variant_builder_add (&props, "{sv}", "visible", g_variant_new_boolean (TRUE));
+    }
+
+  if (PNL_IS_DOCK_WIDGET (widget) && pnl_dock_widget_get_title (PNL_DOCK_WIDGET (widget)))
+    {
+      const gchar *title = pnl_dock_widget_get_title (PNL_DOCK_WIDGET (widget));
+
+      g_variant_builder_add (&props, "{sv}", "title", g_variant_new_string (title));
+    }
+  else if (PNL_IS_DOCK_BIN_EDGE (widget))
+    {
+      gint position = pnl_dock_bin_edge_get_position (PNL_DOCK_BIN_EDGE (widget));
+      gboolean reveal = gtk_revealer_get_reveal_child (GTK_REVEALER (widget));
+
+      g_variant_builder_add (&props, "{sv}", "edge-position", g_variant_new_int32 (position));
+      g_variant_builder_add (&props, "{sv}", "reveal-child", g_variant_new_boolean (reveal));
+    }
+  else if (PNL_IS_DOCK_OVERLAY_EDGE (widget))
+    {
+      gint position = pnl_dock_overlay_edge_get_position (PNL_DOCK_OVERLAY_EDGE (widget));
+
+      g_variant_builder_add (&props, "{sv}", "edge-position", g_variant_new_int32 (position));
+    }
+
+  nodes = pnl_dock_get_child_nodes (widget);
+  for (i = 0; i < nodes->len; i++)
+    g_variant_builder_add (&children, "v", pnl_dock_save_node (g_ptr_array_index (nodes, i)));
+  g_ptr_array_unref (nodes);
+
+  return g_variant_new ("(s@a{sv}@av)",
+                        G_OBJECT_TYPE_NAME (widget),
+                        g_variant_builder_end (&props),
+                        g_variant_builder_end (&children));
+}
+
+/**
+ * pnl_dock_save_layout:
+ * @self: A #PnlDock
+ *
+ * Captures the layout of the dock tree below @self: the edge sizes,
+ * priorities and reveal state of #PnlDockBin and #PnlDockOverlay, the
+ * child positions of every #PnlMultiPaned, and the page order and
+ * visible page of every #PnlDockStack.
+ *
+ * The result is a versioned, serialized blob that can be written to disk
+ * with g_variant_get_data() and restored with pnl_dock_load_layout().
+ *
+ * Returns: (transfer full): a #GVariant of type "(uv)".
+ */
+GVariant *
+pnl_dock_save_layout (PnlDock *self)
+{
+  GVariant *node;
+
+  g_return_val_if_fail (PNL_IS_DOCK (self), NULL);
+
+  node = pnl_dock_save_node (GTK_WIDGET (self));
+
+  return g_variant_ref_sink (g_variant_new ("(uv)", LAYOUT_VERSION, node));
+}
+
+static GtkWidget *
+pnl_dock_match_node (GPtrArray   *nodes,
+                     const gchar *type_name,
+                     const gchar *title)
+{
+  guint i;
+
+  g_assert (nodes != NULL);
+  g_assert (type_name != NULL);
+
+  for (i = 0; i < nodes->len; i++)
+    {
+      GtkWidget *widget = g_ptr_array_index (nodes, i);
+
+      if (widget == NULL || g_strcmp0 (G_OBJECT_TYPE_NAME (widget), type_name) != 0)
+        continue;
+
+      if (title != NULL &&
+          (!PNL_IS_DOCK_WIDGET (widget) ||
+           g_strcmp0 (title, pnl_dock_widget_get_title (PNL_DOCK_WIDGET (widget))) != 0))
+        continue;
+
+      /* Each live widget can only be matched once. */
+      g_ptr_array_index (nodes, i) = NULL;
+
+      return widget;
+    }
+
+  return NULL;
+}
+
+static void
+pnl_dock_load_node (GtkWidget *widget,
+                    GVariant  *node)
+{
+  GVariantDict dict;
+  GVariant *props = NULL;
+  GVariant *children = NULL;
+  GtkWidget *parent;
+  GtkWidget *visible = NULL;
+  GPtrArray *nodes;
+  gboolean reveal;
+  gsize n_children;
+  gsize i;
+  gint position = 0;
+  gint stack_position = 0;
+
+  g_assert (GTK_IS_WIDGET (widget));
+  g_assert (g_variant_is_of_type (node, G_VARIANT_TYPE (NODE_TYPE_STRING)));
+
+  g_variant_get (node, "(&s@a{sv}@av)", NULL, &props, &children);
+  g_variant_dict_init (&dict, props);
+
+  parent = gtk_widget_get_parent (widget);
+
+  if (PNL_IS_MULTI_PANED (parent) &&
+      g_variant_dict_lookup (&dict, "position", "i", &position))
+    gtk_container_child_set (GTK_CONTAINER (parent), widget, "position", MAX (0, position), NULL);
+  else if (PNL_IS_DOCK_BIN (parent) &&
+           g_variant_dict_lookup (&dict, "priority", "i", &position))
+    gtk_container_child_set (GTK_CONTAINER (parent), widget, "priority", position, NULL);
+  else if (PNL_IS_DOCK_OVERLAY (parent) &&
+           g_variant_dict_lookup (&dict, "reveal", "b", &reveal))
+    gtk_container_child_set (GTK_CONTAINER (parent), widget, "reveal", reveal, NULL);
+
+  if (PNL_IS_DOCK_BIN_EDGE (widget))
+    {
+      if (g_variant_dict_lookup (&dict, "edge-position", "i", &position))
+        pnl_dock_bin_edge_set_position (PNL_DOCK_BIN_EDGE (widget), MAX (0, position));
+
+      if (g_variant_dict_lookup (&dict, "reveal-child", "b", &reveal))
+        gtk_revealer_set_reveal_child (GTK_REVEALER (widget), reveal);
+    }
+  else if (PNL_IS_DOCK_OVERLAY_EDGE (widget))
+    {
+      if (g_variant_dict_lookup (&dict, "edge-position", "i", &position))
+        pnl_dock_overlay_edge_set_position (PNL_DOCK_OVERLAY_EDGE (widget), MAX (0, position));
+    }
+
+  g_variant_dict_clear (&dict);
+
+  /*
+   * Positions set while frozen are kept as-is rather than being
+   * redistributed when the layout is thawed.
+   */
+  if (PNL_IS_MULTI_PANED (widget))
+    pnl_multi_paned_freeze_layout (PNL_MULTI_PANED (widget));
+
+  nodes = pnl_dock_get_child_nodes (widget);
+  n_children = g_variant_n_children (children);
+
+  for (i = 0; i < n_children; i++)
+    {
+      GVariant *child_node;
+      GVariant *child_props = NULL;
+      const gchar *type_name = NULL;
+      const gchar *title = NULL;
+      GtkWidget *child;
+      GtkWidget *child_parent;
+      gboolean is_visible = FALSE;
+
+      g_variant_get_child (children, i, "v", &child_node);
+
+      if (!g_variant_is_of_type (child_node, G_VARIANT_TYPE (NODE_TYPE_STRING)))
+        {
+          g_variant_unref (child_node);
+          continue;
+        }
+
+      g_variant_get (child_node, "(&s@a{sv}@av)", &type_name, &child_props, NULL);
+      g_variant_lookup (child_props, "title", "&s", &title);
+      g_variant_lookup (child_props, "visible", "b", &is_visible);
+
+      /*
+       * Pages are matched by title so that they can be reordered, the
+       * rest of the tree must line up with what was saved.
+       */
+      child = pnl_dock_match_node (nodes, type_name, title);
+
+      if (child != NULL)
+        {
+          child_parent = gtk_widget_get_parent (child);
+
+          if (GTK_IS_STACK (child_parent))
+            {
+              gtk_container_child_set (GTK_CONTAINER (child_parent), child,
+                                       "position", stack_position++,
+                                       NULL);
+              if (is_visible)
+                visible = child;
+            }
+
+          pnl_dock_load_node (child, child_node);
+        }
+
+      g_variant_unref (child_props);
+      g_variant_unref (child_node);
+    }
+
+  g_ptr_array_unref (nodes);
+
+  if (visible != NULL)
+    gtk_stack_set_visible_child (GTK_STACK (gtk_widget_get_parent (visible)), visible);
+
+  if (PNL_IS_MULTI_PANED (widget))
+    pnl_multi_paned_thaw_layout (PNL_MULTI_PANED (widget));
+
+  g_variant_unref (props);
+  g_variant_unref (children);
+}
+
+/**
+ * pnl_dock_load_layout:
+ * @self: A #PnlDock
+ * @layout: a #GVariant created with pnl_dock_save_layout()
+ *
+ * Applies a layout previously captured with pnl_dock_save_layout() to
+ * the dock tree below @self in a single pass. The tree should have the
+ * same shape as when it was saved, such as when it is created from the
+ * same #GtkBuilder description; pages of a #PnlDockStack are matched by
+ * title, and anything that cannot be matched is left untouched.
+ *
+ * Call this before @self is first shown so that edges and panes are
+ * allocated at their restored size right away. A saved layout can be
+ * loaded without copying by wrapping a #GMappedFile in a #GBytes and
+ * passing it to g_variant_new_from_bytes() with the type "(uv)".
+ *
+ * Returns: %TRUE if the layout was applied, %FALSE if it was created by
+ *   an incompatible version.
+ */
+gboolean
+pnl_dock_load_layout (PnlDock  *self,
+                      GVariant *layout)
+{
+  GVariant *node = NULL;
+  guint version = 0;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (PNL_IS_DOCK (self), FALSE);
+  g_return_val_if_fail (layout != NULL, FALSE);
+
+  if (!g_variant_is_of_type (layout, G_VARIANT_TYPE ("(uv)")))
+    return FALSE;
+
+  g_variant_get (layout, "(uv)", &version, &node);
+
+  if (version == LAYOUT_VERSION &&
+      g_variant_is_of_type (node, G_VARIANT_TYPE (NODE_TYPE_STRING)))
+    {
+      pnl_dock_load_node (GTK_WIDGET (self), node);
+      ret = TRUE;
+    }
+
+  g_variant_unref (node);
+
+  return ret;
+}
+
+static void
+pnl_dock_autosave_free (gpointer data)
+{
+  PnlDockAutosave *state = data;
+
+  if (state->source != 0)
+    g_source_remove (state->source);
+
+  g_cancellable_cancel (state->cancellable);
+
+  g_clear_object (&state->cancellable);
+  g_clear_object (&state->file);
+  g_slice_free (PnlDockAutosave, state);
+}
+
+static void
+pnl_dock_autosave_write_free (gpointer data)
+{
+  PnlDockAutosaveWrite *write = data;
+
+  g_clear_object (&write->file);
+  g_clear_pointer (&write->bytes, g_bytes_unref);
+  g_slice_free (PnlDockAutosaveWrite, write);
+}
+
+static void
+pnl_dock_autosave_worker (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  PnlDockAutosaveWrite *write = task_data;
+  GFile *parent;
+  GError *error = NULL;
+
+  g_assert (G_IS_TASK (task));
+  g_assert (write != NULL);
+
+  parent = g_file_get_parent (write->file);
+
+  if (parent != NULL &&
+      !g_file_make_directory_with_parents (parent, cancellable, &error) &&
+      !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_EXISTS))
+    {
+      g_object_unref (parent);
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_clear_error (&error);
+  g_clear_object (&parent);
+
+  /* This writes to a temporary file and renames it over the old one. */
+  if (!g_file_replace_contents (write->file,
+                                g_bytes_get_data (write->bytes, NULL),
+                                g_bytes_get_size (write->bytes),
+                                NULL,
+                                FALSE,
+                                G_FILE_CREATE_REPLACE_DESTINATION,
+                                NULL,
+                                cancellable,
+                                &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void pnl_dock_autosave_schedule (PnlDockAutosave *state);
+
+static void
+pnl_dock_autosave_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  PnlDock *self = (PnlDock *)object;
+  PnlDockAutosave *state;
+  GError *error = NULL;
+
+  g_assert (PNL_IS_DOCK (self));
+  g_assert (G_IS_TASK (result));
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to save dock layout: %s", error->message);
+      g_clear_error (&error);
+    }
+
+  /* The autosave file may have been changed while we were writing. */
+  state = g_object_get_qdata (G_OBJECT (self), autosave_quark);
+
+  if (state == NULL || g_task_get_cancellable (G_TASK (result)) != state->cancellable)
+    return;
+
+  state->in_flight = FALSE;
+
+  if (state->dirty)
+    {
+      state->dirty = FALSE;
+      pnl_dock_autosave_schedule (state);
+    }
+}
+
+static gboolean
+pnl_dock_autosave_timeout (gpointer user_data)
+{
+  PnlDockAutosave *state = user_data;
+  PnlDockAutosaveWrite *write;
+  GVariant *layout;
+  GTask *task;
+
+  g_assert (state != NULL);
+  g_assert (PNL_IS_DOCK (state->dock));
+
+  state->source = 0;
+
+  /* Never have two writes to the same file racing each other. */
+  if (state->in_flight)
+    {
+      state->dirty = TRUE;
+      return G_SOURCE_REMOVE;
+    }
+
+  /* Only the snapshot is taken here, the widgets cannot be used from the worker. */
+  layout = pnl_dock_save_layout (state->dock);
+
+  write = g_slice_new0 (PnlDockAutosaveWrite);
+  write->file = g_object_ref (state->file);
+  write->bytes = g_variant_get_data_as_bytes (layout);
+
+  g_variant_unref (layout);
+
+  state->in_flight = TRUE;
+
+  task = g_task_new (state->dock, state->cancellable, pnl_dock_autosave_cb, NULL);
+  g_task_set_source_tag (task, pnl_dock_autosave_timeout);
+  g_task_set_task_data (task, write, pnl_dock_autosave_write_free);
+  g_task_run_in_thread (task, pnl_dock_autosave_worker);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+pnl_dock_autosave_schedule (PnlDockAutosave *state)
+{
+  g_assert (state != NULL);
+
+  if (state->source == 0)
+    state->source = g_timeout_add (AUTOSAVE_DELAY_MSEC, pnl_dock_autosave_timeout, state);
+}
+
+/*
+ * pnl_dock_queue_autosave:
+ *
+ * Called by the dock widgets when the user has finished changing the
+ * layout. Saves the layout of every enclosing #PnlDock that has an
+ * autosave file, once the burst of changes is over.
+ */
+void
+pnl_dock_queue_autosave (GtkWidget *widget)
+{
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  for (; widget != NULL; widget = gtk_widget_get_parent (widget))
+    {
+      PnlDockAutosave *state;
+
+      if (!PNL_IS_DOCK (widget))
+        continue;
+
+      if (NULL != (state = g_object_get_qdata (G_OBJECT (widget), autosave_quark)))
+        pnl_dock_autosave_schedule (state);
+    }
+}
+
+/**
+ * pnl_dock_get_autosave_file:
+ * @self: A #PnlDock
+ *
+ * Returns: (transfer none) (nullable): the file set with
+ *   pnl_dock_set_autosave_file(), or %NULL.
+ */
+GFile *
+pnl_dock_get_autosave_file (PnlDock *self)
+{
+  PnlDockAutosave *state;
+
+  g_return_val_if_fail (PNL_IS_DOCK (self), NULL);
+
+  state = g_object_get_qdata (G_OBJECT (self), autosave_quark);
+
+  return state != NULL ? state->file : NULL;
+}
+
+/**
+ * pnl_dock_set_autosave_file:
+ * @self: A #PnlDock
+ * @file: (nullable): a #GFile, or %NULL to stop saving
+ *
+ * Saves the layout of @self to @file, in the format of
+ * pnl_dock_save_layout(), whenever the user finishes changing it: after
+ * resizing an edge or a pane, revealing or hiding an edge, or switching
+ * pages. Changes are coalesced and the file is written from a worker
+ * thread, replacing the previous contents atomically.
+ *
+ * Set this after restoring the layout with pnl_dock_load_layout() so
+ * that the restored layout is not written straight back.
+ */
+void
+pnl_dock_set_autosave_file (PnlDock *self,
+                            GFile   *file)
+{
+  PnlDockAutosave *state = NULL;
+
+  g_return_if_fail (PNL_IS_DOCK (self));
+  g_return_if_fail (!file || G_IS_FILE (file));
+
+  if (file != NULL)
+    {
+      state = g_slice_new0 (PnlDockAutosave);
+      state->dock = self;
+      state->file = g_object_ref (file);
+      state->cancellable = g_cancellable_new ();
+    }
+
+  g_object_set_qdata_full (G_OBJECT (self), autosave_quark, state, pnl_dock_autosave_free);
+}
@@ -32,6 +32,13 @@ struct _PnlDockInterface
   GTypeInterface parent;
 };
 
+GVariant *pnl_dock_save_layout       (PnlDock  *self);
+gboolean  pnl_dock_load_layout       (PnlDock  *self,
+                                      GVariant *layout);
+GFile    *pnl_dock_get_autosave_file (PnlDock  *self);
+void      pnl_dock_set_autosave_file (PnlDock  *self,
+                                      GFile    *file);
+
 G_END_DECLS
 
 #endif /* PNL_DOCK_H */
@@ -0,0 +1,35 @@
+/* pnl-multi-paned-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PNL_MULTI_PANED_PRIVATE_H
+#define PNL_MULTI_PANED_PRIVATE_H
+
+#include "pnl-multi-paned.h"
+
+G_BEGIN_DECLS
+
+void  pnl_multi_paned_set_child_position       (PnlMultiPaned *self,
+                                                GtkWidget     *widget,
+                                                gint           position);
+guint pnl_multi_paned_get_n_measure_calls      (PnlMultiPaned *self);
+guint pnl_multi_paned_get_n_visibility_queries (PnlMultiPaned *self);
+void  pnl_multi_paned_reset_counters           (PnlMultiPaned *self);
+
+G_END_DECLS
+
+#endif /* PNL_MULTI_PANED_PRIVATE_H */
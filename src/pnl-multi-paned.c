@@ -17,30 +17,111 @@
  */
 
 #include "pnl-multi-paned.h"
+#include "pnl-multi-paned-private.h"
+#include "pnl-trace-private.h"
 
 #define HANDLE_WIDTH  10
 #define HANDLE_HEIGHT 10
 
 typedef struct
 {
-  GtkWidget *widget;
-  GdkWindow *handle;
-  gint       position;
+  GtkWidget      *widget;
+  gint            position;
+
+  /* Position was set explicitly while the layout was frozen. */
+  guint           position_set : 1;
+
+  /*
+   * Where the resize handle following this child was placed during the
+   * last size allocation, relative to the parent window. Empty if the
+   * child has no handle (hidden or last visible child).
+   */
+  GdkRectangle    handle_rect;
+
+  /*
+   * Cached size request used during size allocation. Each child is
+   * measured once per allocation so the layout pass stays linear in
+   * the number of children.
+   */
+  GtkRequisition  min_req;
+  GtkRequisition  nat_req;
 } PnlMultiPanedChild;
 
 typedef struct
 {
   GArray             *children;
+
+  /*
+   * Map child widgets to their slot in @children (stored as slot + 1).
+   * The array is kept for ordered iteration, this is used for lookups
+   * from GTK+ callbacks.
+   */
+  GHashTable         *widget_to_slot;
+
+  /*
+   * Slots of the visible children in @children, in order. This is rebuilt
+   * when children are added, removed or change visibility so that layout
+   * and drawing never have to scan for the next visible child.
+   */
+  GArray             *visible_children;
+
+  /*
+   * A single input-only window covering our allocation receives events
+   * for all of the resize handles. Its input shape is restricted to the
+   * handle rectangles, and is only pushed to the server when it changes.
+   * Presses are hit-tested against the cached rectangles in process.
+   */
+  GdkWindow          *handle_window;
+  cairo_region_t     *handle_region;
+  GtkAllocation       handle_window_alloc;
+
   GtkGesturePan      *gesture;
   GtkOrientation      orientation;
-  PnlMultiPanedChild *drag_begin;
+
+  /*
+   * The child whose handle is being dragged. We keep the widget rather
+   * than a pointer into @children, which moves when children are added
+   * or removed, and look its slot up when the drag is applied.
+   */
+  GtkWidget          *drag_begin;
   gint                drag_begin_position;
+
+  /*
+   * Pan events can arrive much faster than we draw frames. The latest
+   * position is stashed here and applied from a tick callback during the
+   * frame clock update phase, so we relayout at most once per frame.
+   */
+  gint                drag_pending_position;
+  guint               drag_tick_handler;
+  guint               drag_n_events;
+  guint               drag_n_frames;
+
+  /*
+   * While frozen, adding and removing children does not reset the child
+   * positions or queue a resize. That is done once when thawed.
+   */
+  guint               freeze_count;
+  guint               positions_dirty : 1;
+  guint               frozen_by_builder : 1;
+
+  /*
+   * Number of preferred size and visibility queries made on children, so
+   * that test-multi-paned can check that layout stays linear.
+   */
+  guint               n_measure_calls;
+  guint               n_visibility_queries;
 } PnlMultiPanedPrivate;
 
+static void pnl_multi_paned_init_buildable_iface (GtkBuildableIface *iface);
+
 G_DEFINE_TYPE_EXTENDED (PnlMultiPaned, pnl_multi_paned, GTK_TYPE_CONTAINER, 0,
                         G_ADD_PRIVATE (PnlMultiPaned)
+                        G_IMPLEMENT_INTERFACE (GTK_TYPE_BUILDABLE,
+                                               pnl_multi_paned_init_buildable_iface)
                         G_IMPLEMENT_INTERFACE (GTK_TYPE_ORIENTABLE, NULL))
 
+static GtkBuildableIface *parent_buildable_iface;
+
 enum {
   PROP_0,
   PROP_ORIENTATION,
@@ -69,6 +150,7 @@ static GParamSpec *properties [LAST_CHILD_PROP];
 static GParamSpec *child_properties [LAST_CHILD_PROP];
 static GParamSpec *style_properties [LAST_STYLE_PROP];
 static guint signals [LAST_SIGNAL];
+static gboolean debug_drag;
 
 static void
 pnl_multi_paned_reset_positions (PnlMultiPaned *self)
@@ -78,10 +160,22 @@ pnl_multi_paned_reset_positions (PnlMultiPaned *self)
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
+  if (priv->freeze_count > 0)
+    {
+      priv->positions_dirty = TRUE;
+      return;
+    }
+
   for (i = 0; i < priv->children->len; i++)
     {
       PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
 
+      if (child->position_set)
+        {
+          child->position_set = FALSE;
+          continue;
+        }
+
       if (child->position != 0)
         {
           child->position = 0;
@@ -94,162 +188,302 @@ pnl_multi_paned_reset_positions (PnlMultiPaned *self)
   gtk_widget_queue_resize (GTK_WIDGET (self));
 }
 
-static PnlMultiPanedChild *
-pnl_multi_paned_get_next_visible_child (PnlMultiPaned      *self,
-                                        PnlMultiPanedChild *child)
+static inline guint
+pnl_multi_paned_lookup_slot (GHashTable    *index,
+                             gconstpointer  key)
+{
+  return GPOINTER_TO_UINT (g_hash_table_lookup (index, key)) - 1;
+}
+
+/*
+ * Updates the lookup tables for every child starting from @first. This
+ * needs to be called whenever children are added, removed or reordered.
+ */
+static void
+pnl_multi_paned_reindex (PnlMultiPaned *self,
+                         guint          first)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (child != NULL);
-  g_assert (priv->children != NULL);
-  g_assert (priv->children->len > 0);
 
-  i = child - ((PnlMultiPanedChild *)(gpointer)priv->children->data);
-
-  for (++i; i < priv->children->len; i++)
+  for (i = first; i < priv->children->len; i++)
     {
-      PnlMultiPanedChild *next = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
 
-      if (gtk_widget_get_visible (next->widget))
-        return next;
+      g_hash_table_insert (priv->widget_to_slot, child->widget, GUINT_TO_POINTER (i + 1));
     }
+}
 
-  return NULL;
+static inline gboolean
+pnl_multi_paned_child_get_visible (PnlMultiPaned      *self,
+                                   PnlMultiPanedChild *child)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  priv->n_visibility_queries++;
+
+  return gtk_widget_get_visible (child->widget);
 }
 
+/*
+ * Looks up @slot in the sorted visible index. Returns %TRUE if found.
+ * Either way, @index is set to where @slot is or would be inserted.
+ */
 static gboolean
-pnl_multi_paned_is_last_visible_child (PnlMultiPaned      *self,
-                                       PnlMultiPanedChild *child)
+pnl_multi_paned_find_visible_slot (PnlMultiPaned *self,
+                                   guint          slot,
+                                   guint         *index)
 {
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  guint lo = 0;
+  guint hi;
+
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (child != NULL);
+  g_assert (index != NULL);
+
+  hi = priv->visible_children->len;
 
-  return !pnl_multi_paned_get_next_visible_child (self, child);
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (g_array_index (priv->visible_children, guint, mid) < slot)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  *index = lo;
+
+  return lo < priv->visible_children->len &&
+         g_array_index (priv->visible_children, guint, lo) == slot;
 }
 
 static void
-pnl_multi_paned_get_handle_rect (PnlMultiPaned      *self,
-                                 PnlMultiPanedChild *child,
-                                 GdkRectangle       *handle_rect)
+pnl_multi_paned_child_notify_visible (PnlMultiPaned *self,
+                                      GParamSpec    *pspec,
+                                      GtkWidget     *widget)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  GtkAllocation alloc;
+  PnlMultiPanedChild *child;
+  gboolean found;
+  guint index;
+  guint slot;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (child != NULL);
-  g_assert (handle_rect != NULL);
+  g_assert (GTK_IS_WIDGET (widget));
 
-  handle_rect->x = -1;
-  handle_rect->y = -1;
-  handle_rect->width = 0;
-  handle_rect->height = 0;
+  slot = pnl_multi_paned_lookup_slot (priv->widget_to_slot, widget);
 
-  if (!gtk_widget_get_visible (child->widget) ||
-      !gtk_widget_get_realized (child->widget))
-    return;
+  g_assert (slot < priv->children->len);
+
+  child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
+  found = pnl_multi_paned_find_visible_slot (self, slot, &index);
+
+  if (pnl_multi_paned_child_get_visible (self, child))
+    {
+      if (!found)
+        g_array_insert_val (priv->visible_children, index, slot);
+    }
+  else
+    {
+      if (found)
+        g_array_remove_index (priv->visible_children, index);
+
+      child->handle_rect.x = 0;
+      child->handle_rect.y = 0;
+      child->handle_rect.width = 0;
+      child->handle_rect.height = 0;
+    }
+}
+
+static GdkCursor *
+pnl_multi_paned_create_handle_cursor (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  GdkCursorType cursor_type;
 
-  if (pnl_multi_paned_is_last_visible_child (self, child))
+  g_assert (PNL_IS_MULTI_PANED (self));
+
+  cursor_type = (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+              ? GDK_SB_H_DOUBLE_ARROW
+              : GDK_SB_V_DOUBLE_ARROW;
+
+  return gdk_cursor_new_for_display (gtk_widget_get_display (GTK_WIDGET (self)), cursor_type);
+}
+
+/*
+ * Pushes the cached handle rectangles to the handle window. The window
+ * geometry and input shape are only updated when they changed, so the
+ * cost of an allocation does not depend on the number of handles.
+ */
+static void
+pnl_multi_paned_update_handle_window (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  cairo_region_t *region;
+  GtkAllocation alloc;
+  guint i;
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+
+  if (priv->handle_window == NULL)
     return;
 
-  gtk_widget_get_allocation (child->widget, &alloc);
+  gtk_widget_get_allocation (GTK_WIDGET (self), &alloc);
 
-  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+  if (alloc.x != priv->handle_window_alloc.x ||
+      alloc.y != priv->handle_window_alloc.y ||
+      alloc.width != priv->handle_window_alloc.width ||
+      alloc.height != priv->handle_window_alloc.height)
     {
-      handle_rect->x = alloc.x + alloc.width - (HANDLE_WIDTH / 2);
-      handle_rect->width = HANDLE_WIDTH;
-      handle_rect->y = alloc.y;
-      handle_rect->height = alloc.height;
+      gdk_window_move_resize (priv->handle_window,
+                              alloc.x,
+                              alloc.y,
+                              MAX (1, alloc.width),
+                              MAX (1, alloc.height));
+      priv->handle_window_alloc = alloc;
     }
-  else
+
+  region = cairo_region_create ();
+
+  for (i = 0; i < priv->children->len; i++)
+    {
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      cairo_rectangle_int_t rect;
+
+      if (child->handle_rect.width == 0 || child->handle_rect.height == 0)
+        continue;
+
+      rect.x = child->handle_rect.x - alloc.x;
+      rect.y = child->handle_rect.y - alloc.y;
+      rect.width = child->handle_rect.width;
+      rect.height = child->handle_rect.height;
+
+      cairo_region_union_rectangle (region, &rect);
+    }
+
+  if (priv->handle_region != NULL && cairo_region_equal (region, priv->handle_region))
     {
-      handle_rect->x = alloc.x;
-      handle_rect->width = alloc.width;
-      handle_rect->y = alloc.y + alloc.height - (HANDLE_HEIGHT / 2);
-      handle_rect->height = HANDLE_HEIGHT;
+      cairo_region_destroy (region);
+      return;
     }
+
+  gdk_window_input_shape_combine_region (priv->handle_window, region, 0, 0);
+
+  g_clear_pointer (&priv->handle_region, cairo_region_destroy);
+  priv->handle_region = region;
 }
 
 static void
-pnl_multi_paned_create_child_handle (PnlMultiPaned      *self,
-                                     PnlMultiPanedChild *child)
+pnl_multi_paned_create_handle_window (PnlMultiPaned *self)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   GdkWindowAttr attributes = { 0 };
-  GdkDisplay *display;
+  GtkAllocation alloc;
   GdkWindow *parent;
-  GdkCursorType cursor_type;
-  GdkRectangle handle_rect;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (child != NULL);
-  g_assert (child->handle == NULL);
+  g_assert (priv->handle_window == NULL);
 
-  display = gtk_widget_get_display (GTK_WIDGET (self));
   parent = gtk_widget_get_window (GTK_WIDGET (self));
 
-  cursor_type = (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-              ? GDK_SB_H_DOUBLE_ARROW
-              : GDK_SB_V_DOUBLE_ARROW;
-
-  pnl_multi_paned_get_handle_rect (self, child, &handle_rect);
+  gtk_widget_get_allocation (GTK_WIDGET (self), &alloc);
 
   attributes.window_type = GDK_WINDOW_CHILD;
   attributes.wclass = GDK_INPUT_ONLY;
-  attributes.x = handle_rect.x;
-  attributes.x = -handle_rect.y;
-  attributes.width = handle_rect.width;
-  attributes.height = handle_rect.height;
+  attributes.x = alloc.x;
+  attributes.y = alloc.y;
+  attributes.width = MAX (1, alloc.width);
+  attributes.height = MAX (1, alloc.height);
   attributes.visual = gtk_widget_get_visual (GTK_WIDGET (self));
   attributes.event_mask = (GDK_BUTTON_PRESS_MASK |
                            GDK_BUTTON_RELEASE_MASK |
                            GDK_ENTER_NOTIFY_MASK |
                            GDK_LEAVE_NOTIFY_MASK |
                            GDK_POINTER_MOTION_MASK);
-  attributes.cursor = gdk_cursor_new_for_display (display, cursor_type);
+  attributes.cursor = pnl_multi_paned_create_handle_cursor (self);
 
-  child->handle = gdk_window_new (parent, &attributes, GDK_WA_CURSOR);
-  gtk_widget_register_window (GTK_WIDGET (self), child->handle);
+  priv->handle_window = gdk_window_new (parent, &attributes,
+                                        (GDK_WA_X | GDK_WA_Y | GDK_WA_CURSOR));
+  gtk_widget_register_window (GTK_WIDGET (self), priv->handle_window);
+  priv->handle_window_alloc = alloc;
 
   g_clear_object (&attributes.cursor);
+
+  /* Start out with an empty input shape until we have been allocated. */
+  g_clear_pointer (&priv->handle_region, cairo_region_destroy);
+  pnl_multi_paned_update_handle_window (self);
 }
 
-static gint
-pnl_multi_paned_calc_handle_size (PnlMultiPaned *self)
+static void
+pnl_multi_paned_destroy_handle_window (PnlMultiPaned *self)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  gint visible_children = 0;
-  gint handle_size = 1;
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+
+  if (priv->handle_window != NULL)
+    {
+      gtk_widget_unregister_window (GTK_WIDGET (self), priv->handle_window);
+      gdk_window_destroy (priv->handle_window);
+      priv->handle_window = NULL;
+    }
+
+  g_clear_pointer (&priv->handle_region, cairo_region_destroy);
+}
+
+/*
+ * Finds the child whose handle contains @x,@y (in widget coordinates)
+ * using the rectangles cached during the last size allocation.
+ */
+static PnlMultiPanedChild *
+pnl_multi_paned_get_child_at_handle (PnlMultiPaned *self,
+                                     gdouble        x,
+                                     gdouble        y)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  GtkAllocation alloc;
+  gint px;
+  gint py;
   guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
-  gtk_widget_style_get (GTK_WIDGET (self), "handle-size", &handle_size, NULL);
+  gtk_widget_get_allocation (GTK_WIDGET (self), &alloc);
+
+  px = (gint)x + alloc.x;
+  py = (gint)y + alloc.y;
 
   for (i = 0; i < priv->children->len; i++)
     {
       PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      const GdkRectangle *rect = &child->handle_rect;
 
-      if (gtk_widget_get_visible (child->widget))
-        visible_children++;
+      if (px >= rect->x && px < rect->x + rect->width &&
+          py >= rect->y && py < rect->y + rect->height)
+        return child;
     }
 
-  return MAX (0, (visible_children - 1) * handle_size);
+  return NULL;
 }
 
-static void
-pnl_multi_paned_destroy_child_handle (PnlMultiPaned      *self,
-                                      PnlMultiPanedChild *child)
+static gint
+pnl_multi_paned_calc_handle_size (PnlMultiPaned *self)
 {
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  gint visible_children;
+  gint handle_size = 1;
+
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (child != NULL);
 
-  if (child->handle != NULL)
-    {
-      gdk_window_destroy (child->handle);
-      child->handle = NULL;
-    }
+  gtk_widget_style_get (GTK_WIDGET (self), "handle-size", &handle_size, NULL);
+
+  visible_children = priv->visible_children->len;
+
+  return MAX (0, (visible_children - 1) * handle_size);
 }
 
 static PnlMultiPanedChild *
@@ -257,22 +491,16 @@ pnl_multi_paned_get_child (PnlMultiPaned *self,
                            GtkWidget     *widget)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  guint i;
+  guint slot;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (GTK_IS_WIDGET (widget));
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      if (child->widget == widget)
-        return child;
-    }
+  slot = pnl_multi_paned_lookup_slot (priv->widget_to_slot, widget);
 
-  g_assert_not_reached ();
+  g_assert (slot < priv->children->len);
 
-  return NULL;
+  return &g_array_index (priv->children, PnlMultiPanedChild, slot);
 }
 
 static gint
@@ -289,11 +517,12 @@ pnl_multi_paned_get_child_position (PnlMultiPaned *self,
   return child->position;
 }
 
-static void
+void
 pnl_multi_paned_set_child_position (PnlMultiPaned *self,
                                     GtkWidget     *widget,
                                     gint           position)
 {
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   PnlMultiPanedChild *child;
 
   g_assert (PNL_IS_MULTI_PANED (self));
@@ -302,12 +531,16 @@ pnl_multi_paned_set_child_position (PnlMultiPaned *self,
 
   child = pnl_multi_paned_get_child (self, widget);
 
+  if (priv->freeze_count > 0)
+    child->position_set = TRUE;
+
   if (child->position != position)
     {
       child->position = position;
       gtk_container_child_notify_by_pspec (GTK_CONTAINER (self), widget,
                                            child_properties [CHILD_PROP_POSITION]);
-      gtk_widget_queue_resize (GTK_WIDGET (self));
+      if (priv->freeze_count == 0)
+        gtk_widget_queue_resize (GTK_WIDGET (self));
     }
 }
 
@@ -325,12 +558,27 @@ pnl_multi_paned_add (GtkContainer *container,
   child.widget = g_object_ref_sink (widget);
   child.position = 0;
 
-  if (gtk_widget_get_realized (GTK_WIDGET (self)))
-    pnl_multi_paned_create_child_handle (self, &child);
+  g_array_append_val (priv->children, child);
+  pnl_multi_paned_reindex (self, priv->children->len - 1);
+
+  g_signal_connect_object (widget,
+                           "notify::visible",
+                           G_CALLBACK (pnl_multi_paned_child_notify_visible),
+                           self,
+                           G_CONNECT_SWAPPED);
 
   gtk_widget_set_parent (widget, GTK_WIDGET (self));
 
-  g_array_append_val (priv->children, child);
+  /*
+   * New children always go last, so appending keeps the visible index
+   * sorted. This keeps adding many children while frozen linear.
+   */
+  if (pnl_multi_paned_child_get_visible (self, &child))
+    {
+      guint slot = priv->children->len - 1;
+
+      g_array_append_val (priv->visible_children, slot);
+    }
 
   pnl_multi_paned_reset_positions (self);
 
@@ -343,27 +591,47 @@ pnl_multi_paned_remove (GtkContainer *container,
 {
   PnlMultiPaned *self = (PnlMultiPaned *)container;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  guint index;
+  guint slot;
   guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (GTK_IS_WIDGET (widget));
 
-  for (i = 0; i < priv->children->len; i++)
+  slot = pnl_multi_paned_lookup_slot (priv->widget_to_slot, widget);
+
+  if (slot < priv->children->len)
     {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      g_signal_handlers_disconnect_by_func (widget,
+                                            G_CALLBACK (pnl_multi_paned_child_notify_visible),
+                                            self);
 
-      if (child->widget == widget)
+      /* Drop any pending pan position for the child going away. */
+      if (widget == priv->drag_begin)
         {
-          pnl_multi_paned_destroy_child_handle (self, child);
+          if (priv->drag_tick_handler != 0)
+            {
+              gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_handler);
+              priv->drag_tick_handler = 0;
+            }
 
-          g_array_remove_index (priv->children, i);
-          child = NULL;
+          priv->drag_begin = NULL;
+        }
 
-          gtk_widget_unparent (widget);
-          g_object_unref (widget);
+      g_hash_table_remove (priv->widget_to_slot, widget);
+      g_array_remove_index (priv->children, slot);
 
-          break;
-        }
+      pnl_multi_paned_reindex (self, slot);
+
+      /* Children after @slot moved down by one, so shift their slots too. */
+      if (pnl_multi_paned_find_visible_slot (self, slot, &index))
+        g_array_remove_index (priv->visible_children, index);
+
+      for (i = index; i < priv->visible_children->len; i++)
+        g_array_index (priv->visible_children, guint, i)--;
+
+      gtk_widget_unparent (widget);
+      g_object_unref (widget);
     }
 
   pnl_multi_paned_reset_positions (self);
@@ -414,31 +682,31 @@ pnl_multi_paned_get_preferred_height (GtkWidget *widget,
   guint i;
   gint real_min_height = 0;
   gint real_nat_height = 0;
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (min_height != NULL);
   g_assert (nat_height != NULL);
 
-  for (i = 0; i < priv->children->len; i++)
+  for (i = 0; i < priv->visible_children->len; i++)
     {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
       gint child_min_height = 0;
       gint child_nat_height = 0;
 
-      if (gtk_widget_get_visible (child->widget))
-        {
-          gtk_widget_get_preferred_height (child->widget, &child_min_height, &child_nat_height);
+      gtk_widget_get_preferred_height (child->widget, &child_min_height, &child_nat_height);
+      priv->n_measure_calls++;
 
-          if (priv->orientation == GTK_ORIENTATION_VERTICAL)
-            {
-              real_min_height += child_min_height;
-              real_nat_height += child_nat_height;
-            }
-          else
-            {
-              real_min_height = MAX (real_min_height, child_min_height);
-              real_nat_height = MAX (real_nat_height, child_nat_height);
-            }
+      if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+        {
+          real_min_height += child_min_height;
+          real_nat_height += child_nat_height;
+        }
+      else
+        {
+          real_min_height = MAX (real_min_height, child_min_height);
+          real_nat_height = MAX (real_nat_height, child_nat_height);
         }
     }
 
@@ -452,56 +720,49 @@ pnl_multi_paned_get_preferred_height (GtkWidget *widget,
 
   *min_height = real_min_height;
   *nat_height = real_nat_height;
+
+  PNL_TRACE_END ("PnlMultiPaned.get_preferred_height");
 }
 
 static void
-pnl_multi_paned_get_child_preferred_height_for_width (PnlMultiPaned      *self,
-                                                      PnlMultiPanedChild *children,
-                                                      gint                n_children,
-                                                      gint                width,
-                                                      gint               *min_height,
-                                                      gint               *nat_height)
+pnl_multi_paned_get_child_preferred_height_for_width (PnlMultiPaned *self,
+                                                      gint           width,
+                                                      gint          *min_height,
+                                                      gint          *nat_height)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  PnlMultiPanedChild *child = children;
-  gint child_min_height = 0;
-  gint child_nat_height = 0;
-  gint neighbor_min_height = 0;
-  gint neighbor_nat_height = 0;
+  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (n_children == 0 || children != NULL);
   g_assert (min_height != NULL);
   g_assert (nat_height != NULL);
 
   *min_height = 0;
   *nat_height = 0;
 
-  if (n_children == 0)
-    return;
-
-  if (gtk_widget_get_visible (child->widget))
-    gtk_widget_get_preferred_height_for_width (child->widget,
-                                               width,
-                                               &child_min_height,
-                                               &child_nat_height);
+  for (i = 0; i < priv->visible_children->len; i++)
+    {
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
+      gint child_min_height = 0;
+      gint child_nat_height = 0;
 
-  pnl_multi_paned_get_child_preferred_height_for_width (self,
-                                                        children + 1,
-                                                        n_children - 1,
-                                                        width,
-                                                        &neighbor_min_height,
-                                                        &neighbor_nat_height);
+      gtk_widget_get_preferred_height_for_width (child->widget,
+                                                 width,
+                                                 &child_min_height,
+                                                 &child_nat_height);
+      priv->n_measure_calls++;
 
-  if (priv->orientation == GTK_ORIENTATION_VERTICAL)
-    {
-      *min_height = child_min_height + neighbor_min_height;
-      *nat_height = child_nat_height + neighbor_nat_height;
-    }
-  else
-    {
-      *min_height = MAX (child_min_height, neighbor_min_height);
-      *nat_height = MAX (child_nat_height, neighbor_nat_height);
+      if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+        {
+          *min_height += child_min_height;
+          *nat_height += child_nat_height;
+        }
+      else
+        {
+          *min_height = MAX (*min_height, child_min_height);
+          *nat_height = MAX (*nat_height, child_nat_height);
+        }
     }
 }
 
@@ -513,20 +774,13 @@ pnl_multi_paned_get_preferred_height_for_width (GtkWidget *widget,
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (min_height != NULL);
   g_assert (nat_height != NULL);
 
-  *min_height = 0;
-  *nat_height = 0;
-
-  pnl_multi_paned_get_child_preferred_height_for_width (self,
-                                                        (PnlMultiPanedChild *)(gpointer)priv->children->data,
-                                                        priv->children->len,
-                                                        width,
-                                                        min_height,
-                                                        nat_height);
+  pnl_multi_paned_get_child_preferred_height_for_width (self, width, min_height, nat_height);
 
   if (priv->orientation == GTK_ORIENTATION_VERTICAL)
     {
@@ -535,6 +789,8 @@ pnl_multi_paned_get_preferred_height_for_width (GtkWidget *widget,
       *min_height += handle_size;
       *nat_height += handle_size;
     }
+
+  PNL_TRACE_END ("PnlMultiPaned.get_preferred_height_for_width");
 }
 
 static void
@@ -547,31 +803,31 @@ pnl_multi_paned_get_preferred_width (GtkWidget *widget,
   guint i;
   gint real_min_width = 0;
   gint real_nat_width = 0;
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (min_width != NULL);
   g_assert (nat_width != NULL);
 
-  for (i = 0; i < priv->children->len; i++)
+  for (i = 0; i < priv->visible_children->len; i++)
     {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
       gint child_min_width = 0;
       gint child_nat_width = 0;
 
-      if (gtk_widget_get_visible (child->widget))
-        {
-          gtk_widget_get_preferred_width (child->widget, &child_min_width, &child_nat_width);
+      gtk_widget_get_preferred_width (child->widget, &child_min_width, &child_nat_width);
+      priv->n_measure_calls++;
 
-          if (priv->orientation == GTK_ORIENTATION_VERTICAL)
-            {
-              real_min_width = MAX (real_min_width, child_min_width);
-              real_nat_width = MAX (real_nat_width, child_nat_width);
-            }
-          else
-            {
-              real_min_width += child_min_width;
-              real_nat_width += child_nat_width;
-            }
+      if (priv->orientation == GTK_ORIENTATION_VERTICAL)
+        {
+          real_min_width = MAX (real_min_width, child_min_width);
+          real_nat_width = MAX (real_nat_width, child_nat_width);
+        }
+      else
+        {
+          real_min_width += child_min_width;
+          real_nat_width += child_nat_width;
         }
     }
 
@@ -585,56 +841,49 @@ pnl_multi_paned_get_preferred_width (GtkWidget *widget,
 
   *min_width = real_min_width;
   *nat_width = real_nat_width;
+
+  PNL_TRACE_END ("PnlMultiPaned.get_preferred_width");
 }
 
 static void
-pnl_multi_paned_get_child_preferred_width_for_height (PnlMultiPaned      *self,
-                                                      PnlMultiPanedChild *children,
-                                                      gint                n_children,
-                                                      gint                height,
-                                                      gint               *min_width,
-                                                      gint               *nat_width)
+pnl_multi_paned_get_child_preferred_width_for_height (PnlMultiPaned *self,
+                                                      gint           height,
+                                                      gint          *min_width,
+                                                      gint          *nat_width)
 {
-  PnlMultiPanedChild *child = children;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  gint child_min_width = 0;
-  gint child_nat_width = 0;
-  gint neighbor_min_width = 0;
-  gint neighbor_nat_width = 0;
+  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (n_children == 0 || children != NULL);
   g_assert (min_width != NULL);
   g_assert (nat_width != NULL);
 
   *min_width = 0;
   *nat_width = 0;
 
-  if (n_children == 0)
-    return;
-
-  if (gtk_widget_get_visible (child->widget))
-    gtk_widget_get_preferred_width_for_height (child->widget,
-                                               height,
-                                               &child_min_width,
-                                               &child_nat_width);
+  for (i = 0; i < priv->visible_children->len; i++)
+    {
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
+      gint child_min_width = 0;
+      gint child_nat_width = 0;
 
-  pnl_multi_paned_get_child_preferred_width_for_height (self,
-                                                        children + 1,
-                                                        n_children - 1,
-                                                        height,
-                                                        &neighbor_min_width,
-                                                        &neighbor_nat_width);
+      gtk_widget_get_preferred_width_for_height (child->widget,
+                                                 height,
+                                                 &child_min_width,
+                                                 &child_nat_width);
+      priv->n_measure_calls++;
 
-  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-    {
-      *min_width = child_min_width + neighbor_min_width;
-      *nat_width = child_nat_width + neighbor_nat_width;
-    }
-  else
-    {
-      *min_width = MAX (child_min_width, neighbor_min_width);
-      *nat_width = MAX (child_nat_width, neighbor_nat_width);
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          *min_width += child_min_width;
+          *nat_width += child_nat_width;
+        }
+      else
+        {
+          *min_width = MAX (*min_width, child_min_width);
+          *nat_width = MAX (*nat_width, child_nat_width);
+        }
     }
 }
 
@@ -646,17 +895,13 @@ pnl_multi_paned_get_preferred_width_for_height (GtkWidget *widget,
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (min_width != NULL);
   g_assert (nat_width != NULL);
 
-  pnl_multi_paned_get_child_preferred_width_for_height (self,
-                                                        (PnlMultiPanedChild *)(gpointer)priv->children->data,
-                                                        priv->children->len,
-                                                        height,
-                                                        min_width,
-                                                        nat_width);
+  pnl_multi_paned_get_child_preferred_width_for_height (self, height, min_width, nat_width);
 
   if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
     {
@@ -665,149 +910,163 @@ pnl_multi_paned_get_preferred_width_for_height (GtkWidget *widget,
       *min_width += handle_size;
       *nat_width += handle_size;
     }
+
+  PNL_TRACE_END ("PnlMultiPaned.get_preferred_width_for_height");
 }
 
 static void
-pnl_multi_paned_child_size_allocate (PnlMultiPaned      *self,
-                                     PnlMultiPanedChild *children,
-                                     gint                n_children,
-                                     GtkAllocation      *allocation,
-                                     gint                total_width,
-                                     gint                total_height,
-                                     gint                handle_size)
+pnl_multi_paned_measure_children (PnlMultiPaned       *self,
+                                  const GtkAllocation *allocation,
+                                  gint                *total_min)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  PnlMultiPanedChild *child = children;
-  GtkAllocation child_alloc = { 0 };
+  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
-  g_assert (n_children == 0 || children != NULL);
   g_assert (allocation != NULL);
+  g_assert (total_min != NULL);
 
-  if (n_children == 0)
-    return;
+  *total_min = 0;
+
+  for (i = 0; i < priv->visible_children->len; i++)
+    {
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
+
+      child->min_req.width = 0;
+      child->min_req.height = 0;
+      child->nat_req.width = 0;
+      child->nat_req.height = 0;
+
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          gtk_widget_get_preferred_width_for_height (child->widget,
+                                                     allocation->height,
+                                                     &child->min_req.width,
+                                                     &child->nat_req.width);
+          *total_min += child->min_req.width;
+        }
+      else
+        {
+          gtk_widget_get_preferred_height_for_width (child->widget,
+                                                     allocation->width,
+                                                     &child->min_req.height,
+                                                     &child->nat_req.height);
+          *total_min += child->min_req.height;
+        }
+
+      priv->n_measure_calls++;
+    }
+}
+
+static void
+pnl_multi_paned_child_size_allocate (PnlMultiPaned *self,
+                                     GtkAllocation *allocation,
+                                     gint           handle_size)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  gint neighbor_min = 0;
+  guint i;
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+  g_assert (allocation != NULL);
 
   /*
-   * Size allocation is performed by determining the size request of
-   * all children towards the end of the allocation, and then comparing
-   * that to the "position" of this child. If minimum allocations
-   * require, we might fudge our position to allow for following children
-   * to fit.
+   * Size allocation is performed by comparing the "position" of each child
+   * to the minimum size request of all children following it. If minimum
+   * allocations require, we might fudge our position to allow for following
+   * children to fit.
+   *
+   * Every child is measured exactly once up front. We then walk the children
+   * in order, subtracting each child's minimum size from the running total
+   * so that the neighbor requirement is available without re-measuring.
+   * Hidden children are skipped entirely by walking the visible index.
    */
 
-  if (!gtk_widget_get_visible (child->widget))
-    goto next_child;
-
-  child_alloc.x = allocation->x;
-  child_alloc.y = allocation->y;
+  pnl_multi_paned_measure_children (self, allocation, &neighbor_min);
 
-  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+  for (i = 0; i < priv->visible_children->len; i++)
     {
-      gint neighbor_min_width = 0;
-      gint neighbor_nat_width = 0;
-      gint child_min_width = 0;
-      gint child_nat_width = 0;
+      guint slot = g_array_index (priv->visible_children, guint, i);
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
+      GtkAllocation child_alloc = { 0 };
       gint position;
 
-      gtk_widget_get_preferred_width_for_height (child->widget,
-                                                 allocation->height,
-                                                 &child_min_width,
-                                                 &child_nat_width);
-
-      pnl_multi_paned_get_child_preferred_width_for_height (self,
-                                                            children + 1,
-                                                            n_children - 1,
-                                                            allocation->height,
-                                                            &neighbor_min_width,
-                                                            &neighbor_nat_width);
+      child_alloc.x = allocation->x;
+      child_alloc.y = allocation->y;
 
-      child_alloc.height = allocation->height;
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          neighbor_min -= child->min_req.width;
 
-      position = child->position;
+          child_alloc.height = allocation->height;
 
-      if (position == 0)
-        position = child_nat_width;
+          position = child->position;
 
-      if (position < child_min_width)
-        position = child_min_width;
+          if (position == 0)
+            position = child->nat_req.width;
 
-      if ((allocation->width - position - handle_size) < neighbor_min_width)
-        position = allocation->width - handle_size - neighbor_min_width;
+          if (position < child->min_req.width)
+            position = child->min_req.width;
 
-      child_alloc.width = position;
+          if ((allocation->width - position - handle_size) < neighbor_min)
+            position = allocation->width - handle_size - neighbor_min;
 
-      allocation->x += child_alloc.width + handle_size;
-      allocation->width -= child_alloc.width + handle_size;
-    }
-  else
-    {
-      gint neighbor_min_height = 0;
-      gint neighbor_nat_height = 0;
-      gint child_min_height = 0;
-      gint child_nat_height = 0;
-      gint position;
+          child_alloc.width = position;
 
-      gtk_widget_get_preferred_height_for_width (child->widget,
-                                                 allocation->width,
-                                                 &child_min_height,
-                                                 &child_nat_height);
-
-      pnl_multi_paned_get_child_preferred_height_for_width (self,
-                                                            children + 1,
-                                                            n_children - 1,
-                                                            allocation->width,
-                                                            &neighbor_min_height,
-                                                            &neighbor_nat_height);
+          allocation->x += child_alloc.width + handle_size;
+          allocation->width -= child_alloc.width + handle_size;
+        }
+      else
+        {
+          neighbor_min -= child->min_req.height;
 
-      child_alloc.width = allocation->width;
+          child_alloc.width = allocation->width;
 
-      position = child->position;
+          position = child->position;
 
-      if (position == 0)
-        position = child_nat_height;
+          if (position == 0)
+            position = child->nat_req.height;
 
-      if (position < child_min_height)
-        position = child_min_height;
+          if (position < child->min_req.height)
+            position = child->min_req.height;
 
-      if ((allocation->height - position - handle_size) < neighbor_min_height)
-        position = allocation->height - handle_size - neighbor_min_height;
+          if ((allocation->height - position - handle_size) < neighbor_min)
+            position = allocation->height - handle_size - neighbor_min;
 
-      child_alloc.height = position;
+          child_alloc.height = position;
 
-      allocation->y += child_alloc.height + handle_size;
-      allocation->height -= child_alloc.height + handle_size;
-    }
+          allocation->y += child_alloc.height + handle_size;
+          allocation->height -= child_alloc.height + handle_size;
+        }
 
-  if (child->handle != NULL && !pnl_multi_paned_is_last_visible_child (self, child))
-    {
-      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+      if (i + 1 < priv->visible_children->len)
         {
-          gdk_window_move_resize (child->handle,
-                                  child_alloc.x + child_alloc.width - (HANDLE_WIDTH / 2),
-                                  child_alloc.y,
-                                  HANDLE_WIDTH,
-                                  child_alloc.height);
+          if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+            {
+              child->handle_rect.x = child_alloc.x + child_alloc.width - (HANDLE_WIDTH / 2);
+              child->handle_rect.y = child_alloc.y;
+              child->handle_rect.width = HANDLE_WIDTH;
+              child->handle_rect.height = child_alloc.height;
+            }
+          else
+            {
+              child->handle_rect.x = child_alloc.x;
+              child->handle_rect.y = child_alloc.y + child_alloc.height - (HANDLE_HEIGHT / 2);
+              child->handle_rect.width = child_alloc.width;
+              child->handle_rect.height = HANDLE_HEIGHT;
+            }
         }
       else
         {
-          gdk_window_move_resize (child->handle,
-                                  child_alloc.x,
-                                  child_alloc.y + child_alloc.height - (HANDLE_HEIGHT / 2),
-                                  child_alloc.width,
-                                  HANDLE_HEIGHT);
+          child->handle_rect.x = 0;
+          child->handle_rect.y = 0;
+          child->handle_rect.width = 0;
+          child->handle_rect.height = 0;
         }
-    }
 
-  gtk_widget_size_allocate (child->widget, &child_alloc);
-
-next_child:
-  pnl_multi_paned_child_size_allocate (self,
-                                       children + 1,
-                                       n_children - 1,
-                                       allocation,
-                                       total_width,
-                                       total_height,
-                                       handle_size);
+      gtk_widget_size_allocate (child->widget, &child_alloc);
+    }
 }
 
 static void
@@ -838,9 +1097,7 @@ pnl_multi_paned_size_allocate (GtkWidget     *widget,
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   GtkAllocation old_allocation;
   gint single_handle_size = 1;
-  gint handle_size;
-  gint total_width;
-  gint total_height;
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (allocation != NULL);
@@ -850,27 +1107,16 @@ pnl_multi_paned_size_allocate (GtkWidget     *widget,
   GTK_WIDGET_CLASS (pnl_multi_paned_parent_class)->size_allocate (widget, allocation);
 
   if (priv->children->len == 0)
-    return;
+    {
+      pnl_multi_paned_update_handle_window (self);
+      PNL_TRACE_END ("PnlMultiPaned.size_allocate");
+      return;
+    }
 
   gtk_widget_style_get (GTK_WIDGET (self), "handle-size", &single_handle_size, NULL);
 
-  total_width = allocation->width;
-  total_height = allocation->height;
-
-  handle_size = pnl_multi_paned_calc_handle_size (self);
-
-  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-    total_width -= handle_size;
-  else
-    total_height -= handle_size;
-
-  pnl_multi_paned_child_size_allocate (self,
-                                       (PnlMultiPanedChild *)(gpointer)priv->children->data,
-                                       priv->children->len,
-                                       allocation,
-                                       total_width,
-                                       total_height,
-                                       single_handle_size);
+  pnl_multi_paned_child_size_allocate (self, allocation, single_handle_size);
+  pnl_multi_paned_update_handle_window (self);
 
   /*
    * If there is extra space left over in the allocation, divy it out to the
@@ -899,42 +1145,30 @@ pnl_multi_paned_size_allocate (GtkWidget     *widget,
           /* TODO */
         }
     }
+
+  PNL_TRACE_END ("PnlMultiPaned.size_allocate");
 }
 
 static void
 pnl_multi_paned_realize (GtkWidget *widget)
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
-  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
   GTK_WIDGET_CLASS (pnl_multi_paned_parent_class)->realize (widget);
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      pnl_multi_paned_create_child_handle (self, child);
-    }
+  pnl_multi_paned_create_handle_window (self);
 }
 
 static void
 pnl_multi_paned_unrealize (GtkWidget *widget)
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
-  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      pnl_multi_paned_destroy_child_handle (self, child);
-    }
+  pnl_multi_paned_destroy_handle_window (self);
 
   GTK_WIDGET_CLASS (pnl_multi_paned_parent_class)->unrealize (widget);
 }
@@ -944,18 +1178,12 @@ pnl_multi_paned_map (GtkWidget *widget)
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
   GTK_WIDGET_CLASS (pnl_multi_paned_parent_class)->map (widget);
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      gdk_window_show (child->handle);
-    }
+  gdk_window_show (priv->handle_window);
 }
 
 static void
@@ -963,16 +1191,10 @@ pnl_multi_paned_unmap (GtkWidget *widget)
 {
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
-  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      gdk_window_hide (child->handle);
-    }
+  gdk_window_hide (priv->handle_window);
 
   GTK_WIDGET_CLASS (pnl_multi_paned_parent_class)->unmap (widget);
 }
@@ -984,6 +1206,7 @@ pnl_multi_paned_draw (GtkWidget *widget,
   PnlMultiPaned *self = (PnlMultiPaned *)widget;
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   gboolean ret;
+  PNL_TRACE_BEGIN;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (cr != NULL);
@@ -1000,40 +1223,100 @@ pnl_multi_paned_draw (GtkWidget *widget,
 
       gtk_widget_style_get (widget, "handle-size", &handle_size, NULL);
 
-      for (i = 0; i < priv->children->len; i++)
+      /* The last visible child has no handle after it. */
+      for (i = 0; i + 1 < priv->visible_children->len; i++)
         {
-          PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+          guint slot = g_array_index (priv->visible_children, guint, i);
+          PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, slot);
           GtkAllocation alloc;
 
-          if (!gtk_widget_get_realized (child->widget) ||
-              !gtk_widget_get_visible (child->widget))
+          if (!gtk_widget_get_realized (child->widget))
             continue;
 
           gtk_widget_get_allocation (child->widget, &alloc);
 
-          if (!pnl_multi_paned_is_last_visible_child (self, child))
-            {
-              if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-                gtk_render_handle (style_context,
-                                   cr,
-                                   alloc.x + alloc.width,
-                                   alloc.y,
-                                   handle_size,
-                                   alloc.height);
-              else
-                gtk_render_handle (style_context,
-                                   cr,
-                                   alloc.x,
-                                   alloc.y + alloc.height,
-                                   alloc.width,
-                                   handle_size);
-            }
+          if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+            gtk_render_handle (style_context,
+                               cr,
+                               alloc.x + alloc.width,
+                               alloc.y,
+                               handle_size,
+                               alloc.height);
+          else
+            gtk_render_handle (style_context,
+                               cr,
+                               alloc.x,
+                               alloc.y + alloc.height,
+                               alloc.width,
+                               handle_size);
         }
     }
 
+  PNL_TRACE_END ("PnlMultiPaned.draw");
+
   return ret;
 }
 
+static void
+pnl_multi_paned_apply_drag (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  PnlMultiPanedChild *child;
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+  g_assert (priv->drag_begin != NULL);
+
+  child = pnl_multi_paned_get_child (self, priv->drag_begin);
+  child->position = priv->drag_pending_position;
+  priv->drag_n_frames++;
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+}
+
+static gboolean
+pnl_multi_paned_drag_tick_cb (GtkWidget     *widget,
+                              GdkFrameClock *frame_clock,
+                              gpointer       user_data)
+{
+  PnlMultiPaned *self = (PnlMultiPaned *)widget;
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+  g_assert (GDK_IS_FRAME_CLOCK (frame_clock));
+
+  priv->drag_tick_handler = 0;
+
+  if (priv->drag_begin != NULL)
+    pnl_multi_paned_apply_drag (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Applies any pan position that is still waiting for the next frame.
+ * Returns %TRUE if there was one.
+ */
+static gboolean
+pnl_multi_paned_flush_drag (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+
+  if (priv->drag_tick_handler == 0)
+    return FALSE;
+
+  gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_handler);
+  priv->drag_tick_handler = 0;
+
+  if (priv->drag_begin == NULL)
+    return FALSE;
+
+  pnl_multi_paned_apply_drag (self);
+
+  return TRUE;
+}
+
 static void
 pnl_multi_paned_pan_gesture_drag_begin (PnlMultiPaned *self,
                                         gdouble        x,
@@ -1041,9 +1324,9 @@ pnl_multi_paned_pan_gesture_drag_begin (PnlMultiPaned *self,
                                         GtkGesturePan *gesture)
 {
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  PnlMultiPanedChild *child = NULL;
   GdkEventSequence *sequence;
   const GdkEvent *event;
-  guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (GTK_IS_GESTURE_PAN (gesture));
@@ -1055,29 +1338,24 @@ pnl_multi_paned_pan_gesture_drag_begin (PnlMultiPaned *self,
   priv->drag_begin = NULL;
   priv->drag_begin_position = 0;
 
-  for (i = 0; i < priv->children->len; i++)
-    {
-      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
-
-      if (child->handle == event->any.window)
-        {
-          priv->drag_begin = child;
-          break;
-        }
-    }
+  if (event->any.window == priv->handle_window)
+    child = pnl_multi_paned_get_child_at_handle (self, x, y);
 
-  if (priv->drag_begin == NULL)
+  if (child == NULL)
     {
       gtk_gesture_set_state (GTK_GESTURE (gesture), GTK_EVENT_SEQUENCE_DENIED);
       return;
     }
 
-  priv->drag_begin_position = priv->drag_begin->position;
+  priv->drag_begin = child->widget;
+  priv->drag_begin_position = child->position;
+  priv->drag_n_events = 0;
+  priv->drag_n_frames = 0;
 
   gtk_gesture_pan_set_orientation (gesture, priv->orientation);
   gtk_gesture_set_state (GTK_GESTURE (gesture), GTK_EVENT_SEQUENCE_CLAIMED);
 
-  g_signal_emit (self, signals [RESIZE_DRAG_BEGIN], 0, priv->drag_begin->widget);
+  g_signal_emit (self, signals [RESIZE_DRAG_BEGIN], 0, priv->drag_begin);
 }
 
 static void
@@ -1089,6 +1367,7 @@ pnl_multi_paned_pan_gesture_drag_end (PnlMultiPaned *self,
   PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
   GdkEventSequence *sequence;
   GtkEventSequenceState state;
+  gboolean flushed;
   guint i;
 
   g_assert (PNL_IS_MULTI_PANED (self));
@@ -1098,30 +1377,45 @@ pnl_multi_paned_pan_gesture_drag_end (PnlMultiPaned *self,
   sequence = gtk_gesture_single_get_current_sequence (GTK_GESTURE_SINGLE (gesture));
   state = gtk_gesture_get_sequence_state (GTK_GESTURE (gesture), sequence);
 
-  if (state != GTK_EVENT_SEQUENCE_CLAIMED)
+  flushed = pnl_multi_paned_flush_drag (self);
+
+  /* The dragged child may have been removed during the drag. */
+  if (state != GTK_EVENT_SEQUENCE_CLAIMED || priv->drag_begin == NULL)
     goto cleanup;
 
-  g_assert (priv->drag_begin != NULL);
+  if (debug_drag)
+    g_printerr ("%s: %u pan events in %u frames, %u coalesced\n",
+                G_OBJECT_TYPE_NAME (self),
+                priv->drag_n_events,
+                priv->drag_n_frames,
+                priv->drag_n_events - MIN (priv->drag_n_events, priv->drag_n_frames));
 
   for (i = 0; i < priv->children->len; i++)
     {
       PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
       GtkAllocation child_alloc = { 0 };
 
-      if (gtk_widget_get_visible (child->widget))
-        gtk_widget_get_allocation (child->widget, &child_alloc);
+      /*
+       * If we just applied the final pan position, the allocation has not
+       * caught up with it yet, so keep the position we were given.
+       */
+      if (!(flushed && child->widget == priv->drag_begin))
+        {
+          if (pnl_multi_paned_child_get_visible (self, child))
+            gtk_widget_get_allocation (child->widget, &child_alloc);
 
-      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-        child->position = child_alloc.width;
-      else
-        child->position = child_alloc.height;
+          if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+            child->position = child_alloc.width;
+          else
+            child->position = child_alloc.height;
+        }
 
       gtk_container_child_notify_by_pspec (GTK_CONTAINER (self),
                                            child->widget,
                                            child_properties [CHILD_PROP_POSITION]);
     }
 
-  g_signal_emit (self, signals [RESIZE_DRAG_END], 0, priv->drag_begin->widget);
+  g_signal_emit (self, signals [RESIZE_DRAG_END], 0, priv->drag_begin);
 
 cleanup:
   priv->drag_begin = NULL;
@@ -1140,7 +1434,9 @@ pnl_multi_paned_pan_gesture_pan (PnlMultiPaned   *self,
   g_assert (PNL_IS_MULTI_PANED (self));
   g_assert (GTK_IS_GESTURE_PAN (gesture));
   g_assert (gesture == priv->gesture);
-  g_assert (priv->drag_begin != NULL);
+
+  if (priv->drag_begin == NULL)
+    return;
 
   gtk_widget_get_allocation (GTK_WIDGET (self), &alloc);
 
@@ -1157,9 +1453,14 @@ pnl_multi_paned_pan_gesture_pan (PnlMultiPaned   *self,
         offset = -offset;
     }
 
-  priv->drag_begin->position = MAX (0, priv->drag_begin_position + offset);
+  priv->drag_pending_position = MAX (0, priv->drag_begin_position + offset);
+  priv->drag_n_events++;
 
-  gtk_widget_queue_allocate (GTK_WIDGET (self));
+  if (priv->drag_tick_handler == 0)
+    priv->drag_tick_handler =
+      gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                    pnl_multi_paned_drag_tick_cb,
+                                    NULL, NULL);
 }
 
 static void
@@ -1263,6 +1564,8 @@ pnl_multi_paned_finalize (GObject *object)
   g_assert (priv->children->len == 0);
 
   g_clear_pointer (&priv->children, g_array_unref);
+  g_clear_pointer (&priv->widget_to_slot, g_hash_table_unref);
+  g_clear_pointer (&priv->visible_children, g_array_unref);
   g_clear_object (&priv->gesture);
 
   G_OBJECT_CLASS (pnl_multi_paned_parent_class)->finalize (object);
@@ -1301,6 +1604,13 @@ pnl_multi_paned_set_property (GObject      *object,
     {
     case PROP_ORIENTATION:
       priv->orientation = g_value_get_enum (value);
+      if (priv->handle_window != NULL)
+        {
+          GdkCursor *cursor = pnl_multi_paned_create_handle_cursor (self);
+
+          gdk_window_set_cursor (priv->handle_window, cursor);
+          g_object_unref (cursor);
+        }
       gtk_widget_queue_resize (GTK_WIDGET (self));
       break;
 
@@ -1309,6 +1619,61 @@ pnl_multi_paned_set_property (GObject      *object,
     }
 }
 
+static void
+pnl_multi_paned_add_child (GtkBuildable *buildable,
+                           GtkBuilder   *builder,
+                           GObject      *child,
+                           const gchar  *type)
+{
+  PnlMultiPaned *self = (PnlMultiPaned *)buildable;
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+  g_assert (GTK_IS_BUILDER (builder));
+  g_assert (G_IS_OBJECT (child));
+
+  /*
+   * Hold the layout frozen until the builder has finished so that the
+   * children and their packing positions are applied as one batch.
+   */
+  if (!priv->frozen_by_builder)
+    {
+      priv->frozen_by_builder = TRUE;
+      pnl_multi_paned_freeze_layout (self);
+    }
+
+  parent_buildable_iface->add_child (buildable, builder, child, type);
+}
+
+static void
+pnl_multi_paned_parser_finished (GtkBuildable *buildable,
+                                 GtkBuilder   *builder)
+{
+  PnlMultiPaned *self = (PnlMultiPaned *)buildable;
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_assert (PNL_IS_MULTI_PANED (self));
+  g_assert (GTK_IS_BUILDER (builder));
+
+  if (parent_buildable_iface->parser_finished != NULL)
+    parent_buildable_iface->parser_finished (buildable, builder);
+
+  if (priv->frozen_by_builder)
+    {
+      priv->frozen_by_builder = FALSE;
+      pnl_multi_paned_thaw_layout (self);
+    }
+}
+
+static void
+pnl_multi_paned_init_buildable_iface (GtkBuildableIface *iface)
+{
+  parent_buildable_iface = g_type_interface_peek_parent (iface);
+
+  iface->add_child = pnl_multi_paned_add_child;
+  iface->parser_finished = pnl_multi_paned_parser_finished;
+}
+
 static void
 pnl_multi_paned_class_init (PnlMultiPanedClass *klass)
 {
@@ -1320,6 +1685,8 @@ pnl_multi_paned_class_init (PnlMultiPanedClass *klass)
   object_class->set_property = pnl_multi_paned_set_property;
   object_class->finalize = pnl_multi_paned_finalize;
 
+  debug_drag = !!g_getenv ("PNL_DRAG_DEBUG");
+
   widget_class->get_request_mode = pnl_multi_paned_get_request_mode;
   widget_class->get_preferred_width = pnl_multi_paned_get_preferred_width;
   widget_class->get_preferred_height = pnl_multi_paned_get_preferred_height;
@@ -1399,6 +1766,8 @@ pnl_multi_paned_init (PnlMultiPaned *self)
   gtk_widget_set_has_window (GTK_WIDGET (self), FALSE);
 
   priv->children = g_array_new (FALSE, TRUE, sizeof (PnlMultiPanedChild));
+  priv->widget_to_slot = g_hash_table_new (NULL, NULL);
+  priv->visible_children = g_array_new (FALSE, FALSE, sizeof (guint));
 
   pnl_multi_paned_create_pan_gesture (self);
 }
@@ -1418,3 +1787,94 @@ pnl_multi_paned_get_n_children (PnlMultiPaned *self)
 
   return priv->children ? priv->children->len : 0;
 }
+
+/**
+ * pnl_multi_paned_freeze_layout:
+ * @self: A #PnlMultiPaned
+ *
+ * Defers the layout work done when children are added or removed until
+ * pnl_multi_paned_thaw_layout() is called. Use this when building a layout
+ * with many children.
+ *
+ * Child positions set while frozen are kept when the layout is thawed, so
+ * saved positions can be restored before the first allocation.
+ *
+ * Calls may be nested.
+ */
+void
+pnl_multi_paned_freeze_layout (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_MULTI_PANED (self));
+
+  priv->freeze_count++;
+}
+
+/**
+ * pnl_multi_paned_thaw_layout:
+ * @self: A #PnlMultiPaned
+ *
+ * Reverts a previous call to pnl_multi_paned_freeze_layout(). When the
+ * last freeze is released, positions of children that were not explicitly
+ * set are reset and a single resize is queued.
+ */
+void
+pnl_multi_paned_thaw_layout (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+  guint i;
+
+  g_return_if_fail (PNL_IS_MULTI_PANED (self));
+  g_return_if_fail (priv->freeze_count > 0);
+
+  if (--priv->freeze_count > 0)
+    return;
+
+  if (priv->positions_dirty)
+    {
+      priv->positions_dirty = FALSE;
+      pnl_multi_paned_reset_positions (self);
+      return;
+    }
+
+  for (i = 0; i < priv->children->len; i++)
+    {
+      PnlMultiPanedChild *child = &g_array_index (priv->children, PnlMultiPanedChild, i);
+
+      child->position_set = FALSE;
+    }
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
+
+guint
+pnl_multi_paned_get_n_measure_calls (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_MULTI_PANED (self), 0);
+
+  return priv->n_measure_calls;
+}
+
+guint
+pnl_multi_paned_get_n_visibility_queries (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_MULTI_PANED (self), 0);
+
+  return priv->n_visibility_queries;
+}
+
+void
+pnl_multi_paned_reset_counters (PnlMultiPaned *self)
+{
+  PnlMultiPanedPrivate *priv = pnl_multi_paned_get_instance_private (self);
+
+  g_return_if_fail (PNL_IS_MULTI_PANED (self));
+
+  priv->n_measure_calls = 0;
+  priv->n_visibility_queries = 0;
+}
@@ -43,6 +43,8 @@ struct _PnlMultiPanedClass
 
 GtkWidget *pnl_multi_paned_new            (void);
 guint      pnl_multi_paned_get_n_children (PnlMultiPaned *self);
+void       pnl_multi_paned_freeze_layout  (PnlMultiPaned *self);
+void       pnl_multi_paned_thaw_layout    (PnlMultiPaned *self);
 
 G_END_DECLS
 
@@ -23,6 +23,29 @@ typedef struct
 {
   GAction         *action;
   GtkStack        *stack;
+
+  /*
+   * Children of @stack indexed by their "position" child property. This
+   * is kept up to date from child-notify::position so that activating a
+   * tab does not need to scan the stack. Widgets are not referenced.
+   * @positions maps each indexed widget back to its slot (plus one).
+   */
+  GPtrArray       *by_position;
+  GHashTable      *positions;
+
+  /*
+   * When max_tabs is non-zero the strip is virtualized. Only a pool of
+   * up to max_tabs PnlTab widgets is created, and they are rebound to
+   * the pages starting at first_tab as the strip scrolls. Every page is
+   * reachable from the overflow menu.
+   */
+  GPtrArray       *tabs;
+  GtkWidget       *overflow;
+  GMenu           *overflow_menu;
+  guint            max_tabs;
+  guint            first_tab;
+  guint            bind_handler;
+
   GtkPositionType  edge : 2;
 } PnlTabStripPrivate;
 
@@ -31,12 +54,87 @@ G_DEFINE_TYPE_WITH_PRIVATE (PnlTabStrip, pnl_tab_strip, GTK_TYPE_BOX)
 enum {
   PROP_0,
   PROP_EDGE,
+  PROP_MAX_TABS,
   PROP_STACK,
   N_PROPS
 };
 
 static GParamSpec *properties [N_PROPS];
 
+static void pnl_tab_strip_child_position_changed (PnlTabStrip *self,
+                                                  GParamSpec  *pspec,
+                                                  GtkWidget   *child);
+static void pnl_tab_strip_child_title_changed    (PnlTabStrip *self,
+                                                  GParamSpec  *pspec,
+                                                  GtkWidget   *child);
+static void pnl_tab_strip_queue_bind             (PnlTabStrip *self);
+
+static void
+pnl_tab_strip_index_child (PnlTabStrip *self,
+                           GtkWidget   *child,
+                           guint        position)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (GTK_IS_WIDGET (child));
+
+  if (position >= priv->by_position->len)
+    g_ptr_array_set_size (priv->by_position, position + 1);
+
+  g_ptr_array_index (priv->by_position, position) = child;
+  g_hash_table_insert (priv->positions, child, GUINT_TO_POINTER (position + 1));
+}
+
+/*
+ * Returns the slot of @child in by_position, or -1 if it is not indexed.
+ */
+static gint
+pnl_tab_strip_lookup_child (PnlTabStrip *self,
+                            GtkWidget   *child)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+
+  return (gint)GPOINTER_TO_UINT (g_hash_table_lookup (priv->positions, child)) - 1;
+}
+
+/*
+ * Updates the lookup table and the tab targets for the pages in slots
+ * @first to @last, after they were shifted in by_position. Pooled tabs
+ * are retargeted when they are rebound instead.
+ */
+static void
+pnl_tab_strip_reindex (PnlTabStrip *self,
+                       guint        first,
+                       guint        last)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  guint i;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+
+  for (i = first; i <= last && i < priv->by_position->len; i++)
+    {
+      GtkWidget *child = g_ptr_array_index (priv->by_position, i);
+      PnlTab *tab;
+
+      if (child == NULL)
+        continue;
+
+      g_hash_table_insert (priv->positions, child, GUINT_TO_POINTER (i + 1));
+
+      if (priv->max_tabs > 0)
+        continue;
+
+      tab = g_object_get_data (G_OBJECT (child), "PNL_TAB");
+
+      if (PNL_IS_TAB (tab))
+        gtk_actionable_set_action_target_value (GTK_ACTIONABLE (tab), g_variant_new_int32 (i));
+    }
+}
+
 static void
 set_tab_state (GSimpleAction *action,
                GVariant      *state,
@@ -44,8 +142,7 @@ set_tab_state (GSimpleAction *action,
 {
   PnlTabStrip *self = user_data;
   PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
-  const GList *iter;
-  GList *list;
+  GtkWidget *child;
   gint stateval;
 
   g_assert (G_IS_SIMPLE_ACTION (action));
@@ -57,25 +154,298 @@ set_tab_state (GSimpleAction *action,
 
   stateval = g_variant_get_int32 (state);
 
-  list = gtk_container_get_children (GTK_CONTAINER (priv->stack));
+  if (priv->stack == NULL || stateval < 0 || (guint)stateval >= priv->by_position->len)
+    return;
+
+  child = g_ptr_array_index (priv->by_position, stateval);
+
+  if (child != NULL)
+    gtk_stack_set_visible_child (priv->stack, child);
+}
+
+static PnlTab *
+pnl_tab_strip_create_tab (PnlTabStrip *self,
+                          GtkWidget   *widget,
+                          gint         position)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (!widget || GTK_IS_WIDGET (widget));
+
+  return g_object_new (PNL_TYPE_TAB,
+                       "action-name", "tab-strip.tab",
+                       "action-target", g_variant_new_int32 (position),
+                       "edge", priv->edge,
+                       "widget", widget,
+                       NULL);
+}
+
+/*
+ * Creates the tab for a page when the strip is not virtualized. The tab
+ * stays attached to the page for as long as the page is in the stack.
+ */
+static void
+pnl_tab_strip_create_page_tab (PnlTabStrip *self,
+                               GtkWidget   *widget,
+                               gint         position)
+{
+  PnlTab *tab;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (GTK_IS_WIDGET (widget));
+
+  tab = pnl_tab_strip_create_tab (self, widget, position);
+
+  g_object_set_data (G_OBJECT (widget), "PNL_TAB", tab);
+
+  gtk_container_add (GTK_CONTAINER (self), GTK_WIDGET (tab));
+
+  g_object_bind_property (widget, "visible", tab, "visible", G_BINDING_SYNC_CREATE);
+
+  pnl_tab_strip_child_title_changed (self, NULL, widget);
+}
+
+/*
+ * Destroys every tab and detaches them from their pages. The pages stay
+ * indexed so that the tabs can be recreated.
+ */
+static void
+pnl_tab_strip_clear_tabs (PnlTabStrip *self)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  GList *list;
+  GList *iter;
+  guint i;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+
+  for (i = 0; i < priv->by_position->len; i++)
+    {
+      GtkWidget *page = g_ptr_array_index (priv->by_position, i);
+
+      if (page != NULL)
+        g_object_set_data (G_OBJECT (page), "PNL_TAB", NULL);
+    }
+
+  list = gtk_container_get_children (GTK_CONTAINER (self));
 
   for (iter = list; iter != NULL; iter = iter->next)
     {
-      GtkWidget *child = iter->data;
-      gint position = 0;
+      if (PNL_IS_TAB (iter->data))
+        gtk_widget_destroy (iter->data);
+    }
+
+  g_list_free (list);
+
+  g_ptr_array_set_size (priv->tabs, 0);
+  priv->first_tab = 0;
+
+  if (priv->overflow != NULL)
+    gtk_widget_hide (priv->overflow);
+}
+
+static void
+pnl_tab_strip_overflow_toggled (PnlTabStrip     *self,
+                                GtkToggleButton *button)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  guint i;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (GTK_IS_TOGGLE_BUTTON (button));
+
+  if (!gtk_toggle_button_get_active (button) || priv->stack == NULL)
+    return;
+
+  /*
+   * The menu is only built while it is shown, so large stacks cost
+   * nothing here until the user asks for the full list.
+   */
+  g_menu_remove_all (priv->overflow_menu);
+
+  for (i = 0; i < priv->by_position->len; i++)
+    {
+      GtkWidget *page = g_ptr_array_index (priv->by_position, i);
+      g_autofree gchar *title = NULL;
+      GMenuItem *item;
 
-      gtk_container_child_get (GTK_CONTAINER (priv->stack), GTK_WIDGET (child),
-                               "position", &position,
+      if (page == NULL || !gtk_widget_get_visible (page))
+        continue;
+
+      gtk_container_child_get (GTK_CONTAINER (priv->stack), page,
+                               "title", &title,
                                NULL);
 
-      if (position == stateval)
+      item = g_menu_item_new (title, NULL);
+      g_menu_item_set_action_and_target_value (item, "tab-strip.tab", g_variant_new_int32 (i));
+      g_menu_append_item (priv->overflow_menu, item);
+      g_object_unref (item);
+    }
+}
+
+static gboolean
+pnl_tab_strip_tab_scroll_event (PnlTabStrip    *self,
+                                GdkEventScroll *event,
+                                PnlTab         *tab)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  gdouble dx = 0.0;
+  gdouble dy = 0.0;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (event != NULL);
+  g_assert (PNL_IS_TAB (tab));
+
+  switch (event->direction)
+    {
+    case GDK_SCROLL_UP:
+    case GDK_SCROLL_LEFT:
+      dy = -1.0;
+      break;
+
+    case GDK_SCROLL_DOWN:
+    case GDK_SCROLL_RIGHT:
+      dy = 1.0;
+      break;
+
+    case GDK_SCROLL_SMOOTH:
+      gdk_event_get_scroll_deltas ((GdkEvent *)event, &dx, &dy);
+      dy += dx;
+      break;
+
+    default:
+      return GDK_EVENT_PROPAGATE;
+    }
+
+  if (dy < 0.0 && priv->first_tab > 0)
+    priv->first_tab--;
+  else if (dy > 0.0 && priv->first_tab + priv->tabs->len < priv->by_position->len)
+    priv->first_tab++;
+  else
+    return GDK_EVENT_STOP;
+
+  pnl_tab_strip_queue_bind (self);
+
+  return GDK_EVENT_STOP;
+}
+
+/*
+ * Rebinds the pooled tabs to the pages starting at first_tab. This only
+ * touches max_tabs widgets no matter how many pages are in the stack.
+ */
+static void
+pnl_tab_strip_bind_tabs (PnlTabStrip *self)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  guint n_pages;
+  guint n_tabs;
+  guint i;
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+  g_assert (priv->max_tabs > 0);
+
+  n_pages = priv->by_position->len;
+  n_tabs = MIN (priv->max_tabs, n_pages);
+
+  while (priv->tabs->len < n_tabs)
+    {
+      PnlTab *tab = pnl_tab_strip_create_tab (self, NULL, 0);
+
+      gtk_widget_add_events (GTK_WIDGET (tab), GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK);
+      g_signal_connect_object (tab,
+                               "scroll-event",
+                               G_CALLBACK (pnl_tab_strip_tab_scroll_event),
+                               self,
+                               G_CONNECT_SWAPPED);
+
+      g_ptr_array_add (priv->tabs, tab);
+      gtk_container_add (GTK_CONTAINER (self), GTK_WIDGET (tab));
+    }
+
+  while (priv->tabs->len > n_tabs)
+    {
+      PnlTab *tab = g_ptr_array_index (priv->tabs, priv->tabs->len - 1);
+      GtkWidget *page = pnl_tab_get_widget (tab);
+
+      if (page != NULL && g_object_get_data (G_OBJECT (page), "PNL_TAB") == (gpointer)tab)
+        g_object_set_data (G_OBJECT (page), "PNL_TAB", NULL);
+
+      g_ptr_array_remove_index (priv->tabs, priv->tabs->len - 1);
+      gtk_widget_destroy (GTK_WIDGET (tab));
+    }
+
+  if (priv->first_tab + n_tabs > n_pages)
+    priv->first_tab = n_pages - n_tabs;
+
+  for (i = 0; i < n_tabs; i++)
+    {
+      PnlTab *tab = g_ptr_array_index (priv->tabs, i);
+      GtkWidget *page = g_ptr_array_index (priv->by_position, priv->first_tab + i);
+      GtkWidget *old_page = pnl_tab_get_widget (tab);
+
+      if (old_page != page)
         {
-          gtk_stack_set_visible_child (priv->stack, child);
-          break;
+          if (old_page != NULL && g_object_get_data (G_OBJECT (old_page), "PNL_TAB") == (gpointer)tab)
+            g_object_set_data (G_OBJECT (old_page), "PNL_TAB", NULL);
+
+          pnl_tab_set_widget (tab, page);
+        }
+
+      if (page == NULL)
+        {
+          gtk_widget_hide (GTK_WIDGET (tab));
+          continue;
         }
+
+      g_object_set_data (G_OBJECT (page), "PNL_TAB", tab);
+
+      gtk_actionable_set_action_target_value (GTK_ACTIONABLE (tab),
+                                              g_variant_new_int32 (priv->first_tab + i));
+      gtk_widget_set_visible (GTK_WIDGET (tab), gtk_widget_get_visible (page));
+
+      pnl_tab_strip_child_title_changed (self, NULL, page);
     }
 
-  g_list_free (list);
+  gtk_widget_set_visible (priv->overflow, n_pages > n_tabs);
+}
+
+static gboolean
+pnl_tab_strip_bind_tick_cb (GtkWidget     *widget,
+                            GdkFrameClock *frame_clock,
+                            gpointer       user_data)
+{
+  PnlTabStrip *self = (PnlTabStrip *)widget;
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+
+  priv->bind_handler = 0;
+
+  if (priv->max_tabs > 0)
+    pnl_tab_strip_bind_tabs (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Page changes can arrive in bursts (such as restoring a session), so
+ * the pooled tabs are rebound at most once per frame.
+ */
+static void
+pnl_tab_strip_queue_bind (PnlTabStrip *self)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_assert (PNL_IS_TAB_STRIP (self));
+
+  if (priv->max_tabs == 0 || priv->bind_handler != 0)
+    return;
+
+  priv->bind_handler = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                     pnl_tab_strip_bind_tick_cb,
+                                                     NULL,
+                                                     NULL);
 }
 
 static void
@@ -102,14 +472,34 @@ pnl_tab_strip_destroy (GtkWidget *widget)
 
   g_assert (PNL_IS_TAB_STRIP (self));
 
+  if (priv->bind_handler != 0)
+    {
+      gtk_widget_remove_tick_callback (widget, priv->bind_handler);
+      priv->bind_handler = 0;
+    }
+
   pnl_tab_strip_set_stack (self, NULL);
 
   g_clear_object (&priv->action);
+  g_clear_object (&priv->overflow_menu);
   g_clear_object (&priv->stack);
 
   GTK_WIDGET_CLASS (pnl_tab_strip_parent_class)->destroy (widget);
 }
 
+static void
+pnl_tab_strip_finalize (GObject *object)
+{
+  PnlTabStrip *self = (PnlTabStrip *)object;
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_clear_pointer (&priv->by_position, g_ptr_array_unref);
+  g_clear_pointer (&priv->positions, g_hash_table_unref);
+  g_clear_pointer (&priv->tabs, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (pnl_tab_strip_parent_class)->finalize (object);
+}
+
 static void
 pnl_tab_strip_get_property (GObject    *object,
                             guint       prop_id,
@@ -124,6 +514,10 @@ pnl_tab_strip_get_property (GObject    *object,
       g_value_set_enum (value, pnl_tab_strip_get_edge (self));
       break;
 
+    case PROP_MAX_TABS:
+      g_value_set_uint (value, pnl_tab_strip_get_max_tabs (self));
+      break;
+
     case PROP_STACK:
       g_value_set_object (value, pnl_tab_strip_get_stack (self));
       break;
@@ -147,6 +541,10 @@ pnl_tab_strip_set_property (GObject      *object,
       pnl_tab_strip_set_edge (self, g_value_get_enum (value));
       break;
 
+    case PROP_MAX_TABS:
+      pnl_tab_strip_set_max_tabs (self, g_value_get_uint (value));
+      break;
+
     case PROP_STACK:
       pnl_tab_strip_set_stack (self, g_value_get_object (value));
       break;
@@ -163,6 +561,7 @@ pnl_tab_strip_class_init (PnlTabStripClass *klass)
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   GtkContainerClass *container_class = GTK_CONTAINER_CLASS (klass);
 
+  object_class->finalize = pnl_tab_strip_finalize;
   object_class->get_property = pnl_tab_strip_get_property;
   object_class->set_property = pnl_tab_strip_set_property;
 
@@ -178,6 +577,15 @@ pnl_tab_strip_class_init (PnlTabStripClass *klass)
                        GTK_POS_TOP,
                        (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
 
+  properties [PROP_MAX_TABS] =
+    g_param_spec_uint ("max-tabs",
+                       "Max Tabs",
+                       "The maximum number of tabs to create, or 0 for one tab per page",
+                       0,
+                       G_MAXUINT,
+                       0,
+                       (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   properties [PROP_STACK] =
     g_param_spec_object ("stack",
                          "Stack",
@@ -202,6 +610,27 @@ pnl_tab_strip_init (PnlTabStrip *self)
 
   gtk_orientable_set_orientation (GTK_ORIENTABLE (self), GTK_ORIENTATION_HORIZONTAL);
 
+  priv->by_position = g_ptr_array_new ();
+  priv->positions = g_hash_table_new (NULL, NULL);
+  priv->tabs = g_ptr_array_new ();
+
+  priv->overflow_menu = g_menu_new ();
+  priv->overflow = g_object_new (GTK_TYPE_MENU_BUTTON,
+                                 "menu-model", priv->overflow_menu,
+                                 "no-show-all", TRUE,
+                                 "visible", FALSE,
+                                 NULL);
+  g_signal_connect_object (priv->overflow,
+                           "toggled",
+                           G_CALLBACK (pnl_tab_strip_overflow_toggled),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect (priv->overflow,
+                    "destroy",
+                    G_CALLBACK (gtk_widget_destroyed),
+                    &priv->overflow);
+  gtk_box_pack_end (GTK_BOX (self), priv->overflow, FALSE, FALSE, 0);
+
   group = g_simple_action_group_new ();
   g_action_map_add_action_entries (G_ACTION_MAP (group), entries, G_N_ELEMENTS (entries), self);
   priv->action = g_object_ref (g_action_map_lookup_action (G_ACTION_MAP (group), "tab"));
@@ -218,31 +647,70 @@ pnl_tab_strip_child_position_changed (PnlTabStrip *self,
                                       GParamSpec  *pspec,
                                       GtkWidget   *child)
 {
-  GVariant *state;
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
   GtkWidget *parent;
   PnlTab *tab;
-  guint position;
+  gint old_position;
+  gint position = 0;
 
   g_assert (PNL_IS_TAB_STRIP (self));
   g_assert (GTK_IS_WIDGET (child));
 
-  tab = g_object_get_data (G_OBJECT (child), "PNL_TAB");
+  parent = gtk_widget_get_parent (child);
 
-  if (!tab || !PNL_IS_TAB (tab))
+  if (parent == NULL)
     return;
 
-  parent = gtk_widget_get_parent (child);
-
   gtk_container_child_get (GTK_CONTAINER (parent), child,
                            "position", &position,
                            NULL);
 
+  old_position = pnl_tab_strip_lookup_child (self, child);
+
+  if (old_position == position)
+    return;
+
+  /*
+   * GtkStack only notifies the page that moved. The pages between its
+   * old and new position shifted by one, so move the slot and resync
+   * that range rather than overwriting whatever was at @position.
+   */
+  if (old_position >= 0 && (guint)position < priv->by_position->len)
+    {
+      g_ptr_array_remove_index (priv->by_position, old_position);
+      g_ptr_array_insert (priv->by_position, position, child);
+      pnl_tab_strip_reindex (self, MIN (old_position, position), MAX (old_position, position));
+    }
+  else
+    {
+      if (old_position >= 0)
+        g_ptr_array_index (priv->by_position, old_position) = NULL;
+
+      pnl_tab_strip_index_child (self, child, position);
+      pnl_tab_strip_reindex (self, position, position);
+    }
+
+  if (priv->max_tabs > 0)
+    {
+      pnl_tab_strip_queue_bind (self);
+      return;
+    }
+
+  tab = g_object_get_data (G_OBJECT (child), "PNL_TAB");
+
+  if (!PNL_IS_TAB (tab))
+    return;
+
+  /*
+   * The tabs in between follow in our box just like the pages did. The
+   * overflow button was packed first, so the tabs start at box slot 1.
+   */
+  if (priv->overflow != NULL)
+    position++;
+
   gtk_container_child_set (GTK_CONTAINER (self), GTK_WIDGET (tab),
                            "position", position,
                            NULL);
-
-  state = g_variant_new_int32 (position);
-  gtk_actionable_set_action_target_value (GTK_ACTIONABLE (tab), state);
 }
 
 static void
@@ -276,6 +744,7 @@ pnl_tab_strip_stack_notify_visible_child (PnlTabStrip *self,
                                           GParamSpec  *pspec,
                                           GtkStack    *stack)
 {
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
   GtkWidget *visible;
 
   g_assert (PNL_IS_TAB_STRIP (self));
@@ -283,7 +752,29 @@ pnl_tab_strip_stack_notify_visible_child (PnlTabStrip *self,
 
   visible = gtk_stack_get_visible_child (stack);
 
-  if (visible != NULL)
+  if (visible != NULL && priv->max_tabs > 0)
+    {
+      gint position;
+
+      position = pnl_tab_strip_lookup_child (self, visible);
+
+      if (position < 0)
+        return;
+
+      /*
+       * Pooled tabs follow the action state, so update it directly and
+       * scroll the visible page into range if needed.
+       */
+      g_simple_action_set_state (G_SIMPLE_ACTION (priv->action), g_variant_new_int32 (position));
+
+      if ((guint)position < priv->first_tab)
+        priv->first_tab = position;
+      else if ((guint)position >= priv->first_tab + priv->max_tabs)
+        priv->first_tab = position - priv->max_tabs + 1;
+
+      pnl_tab_strip_queue_bind (self);
+    }
+  else if (visible != NULL)
     {
       PnlTab *tab = g_object_get_data (G_OBJECT (visible), "PNL_TAB");
 
@@ -298,8 +789,6 @@ pnl_tab_strip_stack_add (PnlTabStrip *self,
                          GtkStack    *stack)
 {
   PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
-  GVariant *target;
-  PnlTab *tab;
   gint position = 0;
 
   g_assert (PNL_IS_TAB_STRIP (self));
@@ -310,16 +799,7 @@ pnl_tab_strip_stack_add (PnlTabStrip *self,
                            "position", &position,
                            NULL);
 
-  target = g_variant_new_int32 (position);
-
-  tab = g_object_new (PNL_TYPE_TAB,
-                      "action-name", "tab-strip.tab",
-                      "action-target", target,
-                      "edge", priv->edge,
-                      "widget", widget,
-                      NULL);
-
-  g_object_set_data (G_OBJECT (widget), "PNL_TAB", tab);
+  pnl_tab_strip_index_child (self, widget, position);
 
   g_signal_connect_object (widget,
                            "child-notify::position",
@@ -333,11 +813,17 @@ pnl_tab_strip_stack_add (PnlTabStrip *self,
                            self,
                            G_CONNECT_SWAPPED);
 
-  gtk_container_add (GTK_CONTAINER (self), GTK_WIDGET (tab));
+  g_signal_connect_object (widget,
+                           "notify::visible",
+                           G_CALLBACK (pnl_tab_strip_queue_bind),
+                           self,
+                           G_CONNECT_SWAPPED);
 
-  g_object_bind_property (widget, "visible", tab, "visible", G_BINDING_SYNC_CREATE);
+  if (priv->max_tabs > 0)
+    pnl_tab_strip_queue_bind (self);
+  else
+    pnl_tab_strip_create_page_tab (self, widget, position);
 
-  pnl_tab_strip_child_title_changed (self, NULL, widget);
   pnl_tab_strip_stack_notify_visible_child (self, NULL, stack);
 }
 
@@ -346,7 +832,9 @@ pnl_tab_strip_stack_remove (PnlTabStrip *self,
                             GtkWidget   *widget,
                             GtkStack    *stack)
 {
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
   PnlTab *tab;
+  gint position;
 
   g_assert (PNL_IS_TAB_STRIP (self));
   g_assert (GTK_IS_WIDGET (widget));
@@ -354,8 +842,33 @@ pnl_tab_strip_stack_remove (PnlTabStrip *self,
 
   tab = g_object_get_data (G_OBJECT (widget), "PNL_TAB");
 
-  if (PNL_IS_TAB (tab))
-    gtk_container_remove (GTK_CONTAINER (self), GTK_WIDGET (tab));
+  if (priv->max_tabs > 0)
+    {
+      /* Pooled tabs are kept and rebound to the remaining pages. */
+      g_object_set_data (G_OBJECT (widget), "PNL_TAB", NULL);
+      pnl_tab_strip_queue_bind (self);
+    }
+  else if (PNL_IS_TAB (tab))
+    {
+      gtk_container_remove (GTK_CONTAINER (self), GTK_WIDGET (tab));
+    }
+
+  /*
+   * GtkStack does not notify the children that moved up to fill the
+   * hole. Removing the slot shifts them to their new position in our
+   * index, and their tabs already moved up in our box when the tab of
+   * @widget was removed, so only the tab targets need to be updated.
+   */
+  position = pnl_tab_strip_lookup_child (self, widget);
+
+  if (position < 0)
+    return;
+
+  g_hash_table_remove (priv->positions, widget);
+  g_ptr_array_remove_index (priv->by_position, position);
+
+  if ((guint)position < priv->by_position->len)
+    pnl_tab_strip_reindex (self, position, priv->by_position->len - 1);
 }
 
 GtkWidget *
@@ -399,7 +912,9 @@ pnl_tab_strip_set_stack (PnlTabStrip *self,
                                                 G_CALLBACK (pnl_tab_strip_stack_remove),
                                                 self);
 
-          gtk_container_foreach (GTK_CONTAINER (self), (GtkCallback)gtk_widget_destroy, NULL);
+          pnl_tab_strip_clear_tabs (self);
+          g_ptr_array_set_size (priv->by_position, 0);
+          g_hash_table_remove_all (priv->positions);
 
           g_clear_object (&priv->stack);
         }
@@ -506,3 +1021,62 @@ pnl_tab_strip_set_edge (PnlTabStrip     *self,
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_EDGE]);
     }
 }
+
+guint
+pnl_tab_strip_get_max_tabs (PnlTabStrip *self)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+
+  g_return_val_if_fail (PNL_IS_TAB_STRIP (self), 0);
+
+  return priv->max_tabs;
+}
+
+/**
+ * pnl_tab_strip_set_max_tabs:
+ * @self: A #PnlTabStrip
+ * @max_tabs: the maximum number of tabs, or 0
+ *
+ * Limits the number of tab widgets created by the strip. When set, only
+ * @max_tabs tabs are created and they are reused for whichever pages are
+ * scrolled into view. The remaining pages are available from an overflow
+ * menu. This keeps the strip cheap for stacks with many pages.
+ *
+ * If @max_tabs is 0, a tab is created for every page.
+ */
+void
+pnl_tab_strip_set_max_tabs (PnlTabStrip *self,
+                            guint        max_tabs)
+{
+  PnlTabStripPrivate *priv = pnl_tab_strip_get_instance_private (self);
+  guint i;
+
+  g_return_if_fail (PNL_IS_TAB_STRIP (self));
+
+  if (priv->max_tabs == max_tabs)
+    return;
+
+  pnl_tab_strip_clear_tabs (self);
+
+  priv->max_tabs = max_tabs;
+
+  if (max_tabs > 0)
+    {
+      pnl_tab_strip_queue_bind (self);
+    }
+  else
+    {
+      for (i = 0; i < priv->by_position->len; i++)
+        {
+          GtkWidget *page = g_ptr_array_index (priv->by_position, i);
+
+          if (page != NULL)
+            pnl_tab_strip_create_page_tab (self, page, i);
+        }
+    }
+
+  if (priv->stack != NULL)
+    pnl_tab_strip_stack_notify_visible_child (self, NULL, priv->stack);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MAX_TABS]);
+}
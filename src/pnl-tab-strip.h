@@ -43,6 +43,9 @@ void             pnl_tab_strip_set_stack       (PnlTabStrip     *self,
 GtkPositionType  pnl_tab_strip_get_edge        (PnlTabStrip     *self);
 void             pnl_tab_strip_set_edge        (PnlTabStrip     *self,
                                                 GtkPositionType  edge);
+guint            pnl_tab_strip_get_max_tabs    (PnlTabStrip     *self);
+void             pnl_tab_strip_set_max_tabs    (PnlTabStrip     *self,
+                                                guint            max_tabs);
 gboolean         pnl_tab_strip_get_show_labels (PnlTabStrip     *self);
 void             pnl_tab_strip_set_show_labels (PnlTabStrip     *self,
                                                 gboolean         show_labels);
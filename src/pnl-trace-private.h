@@ -0,0 +1,48 @@
+/* pnl-trace-private.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PNL_TRACE_PRIVATE_H
+#define PNL_TRACE_PRIVATE_H
+
+#include "pnl-trace.h"
+
+G_BEGIN_DECLS
+
+/*
+ * PNL_TRACE_BEGIN must be the last declaration of the function being
+ * traced, and every return path must be preceded by PNL_TRACE_END().
+ * Without --enable-tracing both compile to nothing.
+ */
+#ifdef PNL_ENABLE_TRACING
+# define PNL_TRACE_BEGIN \
+  const gint64 pnl_trace_begin_time = g_get_monotonic_time ()
+# define PNL_TRACE_END(mark) \
+  pnl_trace_mark (mark, pnl_trace_begin_time, \
+                  g_get_monotonic_time () - pnl_trace_begin_time)
+#else
+# define PNL_TRACE_BEGIN     G_STMT_START { } G_STMT_END
+# define PNL_TRACE_END(mark) G_STMT_START { } G_STMT_END
+#endif
+
+void pnl_trace_mark (const gchar *mark,
+                     gint64       begin_time,
+                     gint64       duration);
+
+G_END_DECLS
+
+#endif /* PNL_TRACE_PRIVATE_H */
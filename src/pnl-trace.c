@@ -0,0 +1,122 @@
+/* pnl-trace.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pnl-trace.h"
+#include "pnl-trace-private.h"
+
+/*
+ * Marks are delivered to the function registered with pnl_trace_set_func()
+ * and, if PNL_TRACE_FILE is set in the environment, appended to that file
+ * as one "begin_time duration mark" line per mark, with times in
+ * microseconds of the monotonic clock. Layout and drawing only happen on
+ * the GTK+ main thread, so no locking is performed.
+ */
+
+static PnlTraceFunc   trace_func;
+static gpointer       trace_data;
+static GDestroyNotify trace_notify;
+static FILE          *trace_file;
+static gboolean       trace_file_checked;
+
+static void
+pnl_trace_close_file (void)
+{
+  if (trace_file != NULL)
+    {
+      fclose (trace_file);
+      trace_file = NULL;
+    }
+}
+
+/**
+ * pnl_trace_is_supported:
+ *
+ * Checks if the library was compiled with --enable-tracing. If not, no
+ * marks will ever be delivered.
+ *
+ * Returns: %TRUE if tracing marks are recorded.
+ */
+gboolean
+pnl_trace_is_supported (void)
+{
+#ifdef PNL_ENABLE_TRACING
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * pnl_trace_set_func:
+ * @func: (nullable): A #PnlTraceFunc or %NULL.
+ * @user_data: closure data for @func.
+ * @notify: (nullable): A #GDestroyNotify for @user_data.
+ *
+ * Sets the function to be called for every recorded mark, replacing any
+ * previously set function. This can be used to forward marks into a
+ * profiler timeline.
+ */
+void
+pnl_trace_set_func (PnlTraceFunc   func,
+                    gpointer       user_data,
+                    GDestroyNotify notify)
+{
+  GDestroyNotify old_notify = trace_notify;
+  gpointer old_data = trace_data;
+
+  trace_func = func;
+  trace_data = user_data;
+  trace_notify = notify;
+
+  if (old_notify != NULL)
+    old_notify (old_data);
+}
+
+void
+pnl_trace_mark (const gchar *mark,
+                gint64       begin_time,
+                gint64       duration)
+{
+  g_assert (mark != NULL);
+
+  if G_UNLIKELY (!trace_file_checked)
+    {
+      const gchar *path = g_getenv ("PNL_TRACE_FILE");
+
+      trace_file_checked = TRUE;
+
+      if (path != NULL)
+        {
+          if ((trace_file = fopen (path, "w")) != NULL)
+            atexit (pnl_trace_close_file);
+          else
+            g_warning ("Failed to open trace file \"%s\"", path);
+        }
+    }
+
+  if (trace_file != NULL)
+    fprintf (trace_file,
+             "%"G_GINT64_FORMAT" %"G_GINT64_FORMAT" %s\n",
+             begin_time, duration, mark);
+
+  if (trace_func != NULL)
+    trace_func (mark, begin_time, duration, trace_data);
+}
@@ -0,0 +1,51 @@
+/* pnl-trace.h
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(PNL_INSIDE) && !defined(PNL_COMPILATION)
+# error "Only <pnl.h> can be included directly."
+#endif
+
+#ifndef PNL_TRACE_H
+#define PNL_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PnlTraceFunc:
+ * @mark: The name of the traced operation, such as "PnlMultiPaned.size_allocate".
+ * @begin_time: The monotonic time, in microseconds, when the operation began.
+ * @duration: The duration of the operation in microseconds.
+ * @user_data: The closure data provided to pnl_trace_set_func().
+ *
+ * Called with every mark recorded by the library.
+ */
+typedef void (*PnlTraceFunc) (const gchar *mark,
+                              gint64       begin_time,
+                              gint64       duration,
+                              gpointer     user_data);
+
+gboolean pnl_trace_is_supported (void);
+void     pnl_trace_set_func     (PnlTraceFunc   func,
+                                 gpointer       user_data,
+                                 GDestroyNotify notify);
+
+G_END_DECLS
+
+#endif /* PNL_TRACE_H */
@@ -41,6 +41,7 @@ G_BEGIN_DECLS
 #include "pnl-tab.h"
 #include "pnl-tab-strip.h"
 #include "pnl-multi-paned.h"
+#include "pnl-trace.h"
 
 #undef PNL_INSIDE
 
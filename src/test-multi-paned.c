@@ -0,0 +1,255 @@
+/* test-multi-paned.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that PnlMultiPaned layout stays linear in the number of
+ * children, using the counters kept by the container. The layout is
+ * placed in a GtkOffscreenWindow, so this only needs Xvfb or
+ * GDK_BACKEND=broadway. Without a display the test is skipped.
+ */
+
+#include "pnl.h"
+#include "pnl-multi-paned-private.h"
+
+#define N_PANES       64
+#define WINDOW_WIDTH  4096
+#define WINDOW_HEIGHT 600
+
+static void
+flush_events (void)
+{
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+static GtkWidget *
+create_multi_paned (GtkWidget **window)
+{
+  GtkWidget *paned;
+  guint i;
+
+  paned = pnl_multi_paned_new ();
+
+  for (i = 0; i < N_PANES; i++)
+    gtk_container_add (GTK_CONTAINER (paned), gtk_label_new ("Pane"));
+
+  *window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (*window), WINDOW_WIDTH, WINDOW_HEIGHT);
+  gtk_container_add (GTK_CONTAINER (*window), paned);
+  gtk_widget_show_all (*window);
+  flush_events ();
+
+  return paned;
+}
+
+/*
+ * Measures @paned and then resets its counters, so that only the work
+ * done by the following size allocation is counted.
+ */
+static void
+allocate (GtkWidget *paned)
+{
+  GtkAllocation alloc = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+  GtkRequisition min_req;
+
+  gtk_widget_queue_resize (paned);
+  gtk_widget_get_preferred_size (paned, &min_req, NULL);
+
+  pnl_multi_paned_reset_counters (PNL_MULTI_PANED (paned));
+
+  gtk_widget_size_allocate (paned, &alloc);
+}
+
+static void
+test_allocate_measures_once (void)
+{
+  GList *children;
+  GList *iter;
+  GtkWidget *window;
+  GtkWidget *paned;
+  guint n_hidden = 0;
+  guint i = 0;
+
+  paned = create_multi_paned (&window);
+
+  allocate (paned);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (PNL_MULTI_PANED (paned)), ==, N_PANES);
+
+  /* Hidden children must not be measured at all. */
+  children = gtk_container_get_children (GTK_CONTAINER (paned));
+  for (iter = children; iter != NULL; iter = iter->next, i++)
+    {
+      if (i % 4 == 0)
+        {
+          gtk_widget_hide (iter->data);
+          n_hidden++;
+        }
+    }
+  g_list_free (children);
+
+  allocate (paned);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (PNL_MULTI_PANED (paned)), ==, N_PANES - n_hidden);
+
+  gtk_widget_destroy (window);
+  flush_events ();
+}
+
+static void
+test_measure_visible_only (void)
+{
+  PnlMultiPaned *multi_paned;
+  GtkRequisition min_req;
+  GList *children;
+  GList *iter;
+  GtkWidget *window;
+  GtkWidget *paned;
+  gint min_size;
+  gint nat_size;
+  guint n_visible = 0;
+  guint i = 0;
+
+  paned = create_multi_paned (&window);
+  multi_paned = PNL_MULTI_PANED (paned);
+
+  children = gtk_container_get_children (GTK_CONTAINER (paned));
+  for (iter = children; iter != NULL; iter = iter->next, i++)
+    {
+      if (i % 4 == 0)
+        gtk_widget_hide (iter->data);
+      else
+        n_visible++;
+    }
+  g_list_free (children);
+
+  /* Each measuring pass only visits the visible index. */
+  gtk_widget_queue_resize (paned);
+  pnl_multi_paned_reset_counters (multi_paned);
+  gtk_widget_get_preferred_width (paned, &min_size, &nat_size);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (multi_paned), ==, n_visible);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (multi_paned), ==, 0);
+
+  gtk_widget_queue_resize (paned);
+  pnl_multi_paned_reset_counters (multi_paned);
+  gtk_widget_get_preferred_height_for_width (paned, WINDOW_WIDTH, &min_size, &nat_size);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (multi_paned), ==, n_visible);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (multi_paned), ==, 0);
+
+  /* GTK may make several passes here, but never looks at hidden children. */
+  gtk_widget_queue_resize (paned);
+  pnl_multi_paned_reset_counters (multi_paned);
+  gtk_widget_get_preferred_size (paned, &min_req, NULL);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (multi_paned), >, 0);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (multi_paned) % n_visible, ==, 0);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (multi_paned), ==, 0);
+
+  gtk_widget_destroy (window);
+  flush_events ();
+}
+
+static void
+test_visible_children_indexed (void)
+{
+  cairo_surface_t *surface;
+  GList *children;
+  GtkWidget *window;
+  GtkWidget *paned;
+  cairo_t *cr;
+
+  paned = create_multi_paned (&window);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+  /* Allocating and drawing walk the visible index, never the children. */
+  allocate (paned);
+  cr = cairo_create (surface);
+  gtk_widget_draw (paned, cr);
+  cairo_destroy (cr);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (PNL_MULTI_PANED (paned)), ==, 0);
+
+  /* Hiding a child only looks at that child. */
+  pnl_multi_paned_reset_counters (PNL_MULTI_PANED (paned));
+  children = gtk_container_get_children (GTK_CONTAINER (paned));
+  gtk_widget_hide (g_list_nth_data (children, N_PANES / 2));
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (PNL_MULTI_PANED (paned)), ==, 1);
+
+  /* Removing a child shifts the index without any queries. */
+  pnl_multi_paned_reset_counters (PNL_MULTI_PANED (paned));
+  gtk_container_remove (GTK_CONTAINER (paned), children->data);
+  g_list_free (children);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (PNL_MULTI_PANED (paned)), ==, 0);
+
+  allocate (paned);
+  g_assert_cmpuint (pnl_multi_paned_get_n_measure_calls (PNL_MULTI_PANED (paned)), ==, N_PANES - 2);
+  cr = cairo_create (surface);
+  gtk_widget_draw (paned, cr);
+  cairo_destroy (cr);
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (PNL_MULTI_PANED (paned)), ==, 0);
+
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+  flush_events ();
+}
+
+static void
+test_add_while_frozen (void)
+{
+  PnlMultiPaned *multi_paned;
+  GtkWidget *paned;
+  guint i;
+
+  paned = g_object_ref_sink (pnl_multi_paned_new ());
+  multi_paned = PNL_MULTI_PANED (paned);
+
+  /* Adding children looks at each new child only, never the others. */
+  pnl_multi_paned_freeze_layout (multi_paned);
+  pnl_multi_paned_reset_counters (multi_paned);
+
+  for (i = 0; i < N_PANES; i++)
+    {
+      GtkWidget *label = gtk_label_new ("Pane");
+
+      gtk_widget_show (label);
+      gtk_container_add (GTK_CONTAINER (paned), label);
+    }
+
+  g_assert_cmpuint (pnl_multi_paned_get_n_visibility_queries (multi_paned), ==, N_PANES);
+
+  pnl_multi_paned_thaw_layout (multi_paned);
+
+  gtk_widget_destroy (paned);
+  g_object_unref (paned);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (!gtk_init_check (&argc, &argv))
+    {
+      g_printerr ("No display available, skipping.\n");
+      return 77;
+    }
+
+  g_test_add_func ("/MultiPaned/allocate-measures-once", test_allocate_measures_once);
+  g_test_add_func ("/MultiPaned/measure-visible-only", test_measure_visible_only);
+  g_test_add_func ("/MultiPaned/visible-children-indexed", test_visible_children_indexed);
+  g_test_add_func ("/MultiPaned/add-while-frozen", test_add_while_frozen);
+
+  return g_test_run ();
+}
@@ -0,0 +1,189 @@
+/* test-tab-strip.c
+ *
+ * Copyright (C) 2016 Christian Hergert <chergert@redhat.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that PnlTabStrip keeps its page index in sync with the stack
+ * when pages are reordered, both with a tab per page and when the tabs
+ * are virtualized. Without a display the test is skipped.
+ */
+
+#include "pnl.h"
+
+#define N_PAGES 5
+
+static GtkWidget *
+create_tab_strip (GtkStack  **stack,
+                  GtkWidget **pages,
+                  guint       max_tabs)
+{
+  GtkWidget *tab_strip;
+  guint i;
+
+  *stack = g_object_ref_sink (gtk_stack_new ());
+
+  tab_strip = g_object_ref_sink (pnl_tab_strip_new ());
+  pnl_tab_strip_set_max_tabs (PNL_TAB_STRIP (tab_strip), max_tabs);
+  pnl_tab_strip_set_stack (PNL_TAB_STRIP (tab_strip), *stack);
+
+  for (i = 0; i < N_PAGES; i++)
+    {
+      g_autofree gchar *title = g_strdup_printf ("Page %u", i);
+
+      pages [i] = gtk_label_new (title);
+      gtk_widget_show (pages [i]);
+      gtk_stack_add_titled (*stack, pages [i], title, title);
+    }
+
+  return tab_strip;
+}
+
+static void
+activate_tab (GtkWidget *tab_strip,
+              gint       position)
+{
+  GActionGroup *group;
+
+  group = gtk_widget_get_action_group (tab_strip, "tab-strip");
+  g_assert (group != NULL);
+
+  g_action_group_change_action_state (group, "tab", g_variant_new_int32 (position));
+}
+
+/* Moves the first page to the end, as restoring a saved layout would. */
+static void
+reorder_pages (GtkStack  *stack,
+               GtkWidget **pages)
+{
+  GtkWidget *moved = pages [0];
+  guint i;
+
+  gtk_container_child_set (GTK_CONTAINER (stack), moved,
+                           "position", N_PAGES - 1,
+                           NULL);
+
+  for (i = 0; i < N_PAGES - 1; i++)
+    pages [i] = pages [i + 1];
+  pages [N_PAGES - 1] = moved;
+}
+
+static void
+check_activation (GtkWidget  *tab_strip,
+                  GtkStack   *stack,
+                  GtkWidget **pages)
+{
+  guint i;
+
+  for (i = 0; i < N_PAGES; i++)
+    {
+      activate_tab (tab_strip, i);
+      g_assert (gtk_stack_get_visible_child (stack) == pages [i]);
+    }
+}
+
+static void
+test_reorder (void)
+{
+  GtkWidget *pages [N_PAGES];
+  GtkWidget *tab_strip;
+  GtkStack *stack;
+  GList *children;
+  GList *iter;
+  gint n_tabs = 0;
+
+  tab_strip = create_tab_strip (&stack, pages, 0);
+
+  reorder_pages (stack, pages);
+  check_activation (tab_strip, stack, pages);
+
+  /*
+   * Each tab must now target the new position of its page, and the tabs
+   * must be in the same order as the pages.
+   */
+  children = gtk_container_get_children (GTK_CONTAINER (tab_strip));
+
+  for (iter = children; iter != NULL; iter = iter->next)
+    {
+      GVariant *target;
+      GtkWidget *page;
+
+      if (!PNL_IS_TAB (iter->data))
+        continue;
+
+      page = pnl_tab_get_widget (PNL_TAB (iter->data));
+      target = gtk_actionable_get_action_target_value (GTK_ACTIONABLE (iter->data));
+      g_assert_cmpint (g_variant_get_int32 (target), ==, n_tabs);
+      g_assert (page == pages [n_tabs]);
+      n_tabs++;
+    }
+
+  g_list_free (children);
+
+  g_assert_cmpint (n_tabs, ==, N_PAGES);
+
+  gtk_widget_destroy (tab_strip);
+  g_object_unref (tab_strip);
+  gtk_widget_destroy (GTK_WIDGET (stack));
+  g_object_unref (stack);
+}
+
+static void
+test_reorder_virtual (void)
+{
+  GtkWidget *pages [N_PAGES];
+  GtkWidget *tab_strip;
+  GtkStack *stack;
+  GActionGroup *group;
+  GVariant *state;
+
+  tab_strip = create_tab_strip (&stack, pages, 2);
+
+  reorder_pages (stack, pages);
+  check_activation (tab_strip, stack, pages);
+
+  /* Switching pages from the stack must report the new position. */
+  gtk_stack_set_visible_child (stack, pages [N_PAGES - 1]);
+  gtk_stack_set_visible_child (stack, pages [1]);
+
+  group = gtk_widget_get_action_group (tab_strip, "tab-strip");
+  state = g_action_group_get_action_state (group, "tab");
+  g_assert_cmpint (g_variant_get_int32 (state), ==, 1);
+  g_variant_unref (state);
+
+  gtk_widget_destroy (tab_strip);
+  g_object_unref (tab_strip);
+  gtk_widget_destroy (GTK_WIDGET (stack));
+  g_object_unref (stack);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  if (!gtk_init_check (&argc, &argv))
+    {
+      g_printerr ("No display available, skipping.\n");
+      return 77;
+    }
+
+  g_test_add_func ("/TabStrip/reorder", test_reorder);
+  g_test_add_func ("/TabStrip/reorder-virtual", test_reorder_virtual);
+
+  return g_test_run ();
+}